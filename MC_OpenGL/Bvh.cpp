@@ -0,0 +1,285 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+
+#include "Parallel.h"
+#include "RayTriangle.h"
+
+
+namespace {
+
+
+constexpr std::uint32_t	leafFlag			= 0x80000000u;
+// Leaves are tested with the SIMD ray-triangle kernels, so wider leaves cost little.
+constexpr std::uint32_t	maxLeafSize			= 8;
+constexpr int			numBins				= 16;
+
+// Traversal keeps at most one pending node per level, so this also sizes the traversal stack.
+constexpr std::uint32_t	maxDepth			= 62;
+
+// Subtrees with more triangles than this are built on their own thread, down to BuildData::parallelDepth.
+constexpr std::uint32_t	parallelThreshold	= 1 << 14;
+
+
+struct Aabb
+{
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+	auto Grow(const glm::vec3& point) -> void
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	auto Grow(const Aabb& box) -> void
+	{
+		min = glm::min(min, box.min);
+		max = glm::max(max, box.max);
+	}
+
+	auto HalfArea() const -> float
+	{
+		glm::vec3 e = max - min;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+};
+
+
+/// Slab test. Returns the entry distance, or infinity when the ray misses the box before tMax.
+auto IntersectAabb(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& invDirection, float tMax) -> float
+{
+	glm::vec3 t0 = (min - origin) * invDirection;
+	glm::vec3 t1 = (max - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+	float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+	return (tEnter <= tExit) ? tEnter : std::numeric_limits<float>::infinity();
+}
+
+
+}
+
+
+struct MC_OpenGL::Bvh::BuildData
+{
+	std::vector<Aabb>			bounds;
+	std::vector<glm::vec3>		centroids;
+	std::vector<std::uint32_t>	indices;
+	std::uint32_t				parallelDepth	= 0;	// Levels that fork, about WorkerCount() threads in all.
+};
+
+
+auto MC_OpenGL::Bvh::Build(TriangleStore& triangles) -> void
+{
+	m_Nodes.clear();
+	m_FacetIndices.clear();
+	const std::size_t count = triangles.Size();
+	if (count == 0)
+		return;
+
+	const TriangleView view = triangles.View();
+	BuildData data;
+	data.bounds.resize(count);
+	data.centroids.resize(count);
+	data.indices.resize(count);
+	ParallelFor(count, 1 << 14, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			Aabb box;
+			for (int corner = 0; corner < 3; ++corner)
+				box.Grow(view.Vertex(i, corner));
+			data.bounds[i] = box;
+			data.centroids[i] = 0.5f * (box.min + box.max);
+			data.indices[i] = static_cast<std::uint32_t>(i);
+		}
+	});
+
+	while ((std::size_t(1) << data.parallelDepth) < WorkerCount())
+		++data.parallelDepth;
+
+	m_Nodes.reserve(2 * count / maxLeafSize + 1);
+	BuildNode(data, 0, static_cast<std::uint32_t>(count), 0, m_Nodes);
+
+	// Store the triangles in leaf order so the leaves can refer to them by range.
+	triangles.Permute(data.indices);
+	m_FacetIndices = std::move(data.indices);
+}
+
+
+auto MC_OpenGL::Bvh::BuildNode(BuildData& data, std::uint32_t first, std::uint32_t count, std::uint32_t depth, std::vector<Node>& nodes) -> void
+{
+	Aabb bounds;
+	Aabb centroidBounds;
+	for (std::uint32_t i = first; i < first + count; ++i)
+	{
+		bounds.Grow(data.bounds[data.indices[i]]);
+		centroidBounds.Grow(data.centroids[data.indices[i]]);
+	}
+
+	const std::uint32_t nodeIndex = static_cast<std::uint32_t>(nodes.size());
+	nodes.push_back(Node{ bounds.min, first, bounds.max, leafFlag | count });
+	if (count <= maxLeafSize || depth >= maxDepth)
+		return;
+
+	// Bin the centroids along every axis and find the cheapest split by the surface area heuristic.
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = std::numeric_limits<float>::max();
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+		if (extent <= 0.f)
+			continue;
+
+		Aabb binBounds[numBins];
+		std::uint32_t binCounts[numBins] = {};
+		float scale = numBins / extent;
+		for (std::uint32_t i = first; i < first + count; ++i)
+		{
+			std::uint32_t tri = data.indices[i];
+			int bin = std::min(numBins - 1, static_cast<int>((data.centroids[tri][axis] - centroidBounds.min[axis]) * scale));
+			binBounds[bin].Grow(data.bounds[tri]);
+			++binCounts[bin];
+		}
+
+		float rightArea[numBins];
+		std::uint32_t rightCount[numBins];
+		Aabb right;
+		std::uint32_t rightSum = 0;
+		for (int bin = numBins - 1; bin > 0; --bin)
+		{
+			right.Grow(binBounds[bin]);
+			rightSum += binCounts[bin];
+			rightArea[bin] = right.HalfArea();
+			rightCount[bin] = rightSum;
+		}
+
+		Aabb left;
+		std::uint32_t leftSum = 0;
+		for (int split = 1; split < numBins; ++split)
+		{
+			left.Grow(binBounds[split - 1]);
+			leftSum += binCounts[split - 1];
+			if (leftSum == 0 || rightCount[split] == 0)
+				continue;
+
+			float cost = left.HalfArea() * leftSum + rightArea[split] * rightCount[split];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	const float leafCost = bounds.HalfArea() * count;
+	if (bestAxis < 0 || (bestCost >= leafCost && count <= 4 * maxLeafSize))
+		return;
+
+	const float splitMin = centroidBounds.min[bestAxis];
+	const float splitScale = numBins / (centroidBounds.max[bestAxis] - splitMin);
+	auto middle = std::partition(data.indices.begin() + first, data.indices.begin() + first + count, [&](std::uint32_t tri)
+	{
+		return std::min(numBins - 1, static_cast<int>((data.centroids[tri][bestAxis] - splitMin) * splitScale)) < bestSplit;
+	});
+
+	const std::uint32_t leftCount = static_cast<std::uint32_t>(middle - data.indices.begin()) - first;
+	const std::uint32_t rightCount = count - leftCount;
+
+	// Large subtrees are built into their own node lists in parallel and spliced in afterwards.
+	auto Splice = [&nodes](const std::vector<Node>& subtree) -> std::uint32_t
+	{
+		const std::uint32_t offset = static_cast<std::uint32_t>(nodes.size());
+		for (Node node : subtree)
+		{
+			if ((node.countOrRight & leafFlag) == 0)
+			{
+				node.leftOrFirst += offset;
+				node.countOrRight += offset;
+			}
+			nodes.push_back(node);
+		}
+		return offset;
+	};
+
+	std::uint32_t leftIndex;
+	std::uint32_t rightIndex;
+	if (count > parallelThreshold && depth < data.parallelDepth)
+	{
+		std::vector<Node> leftNodes;
+		std::vector<Node> rightNodes;
+		auto leftBuild = std::async(std::launch::async, [&]() { BuildNode(data, first, leftCount, depth + 1, leftNodes); });
+		BuildNode(data, first + leftCount, rightCount, depth + 1, rightNodes);
+		leftBuild.get();
+
+		leftIndex = Splice(leftNodes);
+		rightIndex = Splice(rightNodes);
+	}
+	else
+	{
+		leftIndex = static_cast<std::uint32_t>(nodes.size());
+		BuildNode(data, first, leftCount, depth + 1, nodes);
+		rightIndex = static_cast<std::uint32_t>(nodes.size());
+		BuildNode(data, first + leftCount, rightCount, depth + 1, nodes);
+	}
+
+	nodes[nodeIndex].leftOrFirst = leftIndex;
+	nodes[nodeIndex].countOrRight = rightIndex;
+}
+
+
+auto MC_OpenGL::Bvh::Intersect(const TriangleView& triangles, const glm::vec3& origin, const glm::vec3& direction) const -> BvhHit
+{
+	BvhHit result;
+	if (m_Nodes.empty())
+		return result;
+
+	const glm::vec3 invDirection = glm::vec3(1.f) / direction;
+
+	float tBest = std::numeric_limits<float>::infinity();
+	std::uint32_t stack[maxDepth + 2];
+	int stackSize = 0;
+	if (IntersectAabb(m_Nodes[0].min, m_Nodes[0].max, origin, invDirection, tBest) < tBest)
+		stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = m_Nodes[stack[--stackSize]];
+		if ((node.countOrRight & leafFlag) != 0)
+		{
+			if (IntersectRayTriangles(triangles, node.leftOrFirst, node.countOrRight & ~leafFlag, origin, direction, tBest, result.triangle))
+				result.hit = true;
+			continue;
+		}
+
+		// Visit the nearer child first so that the farther one is more likely to be culled by tBest.
+		std::uint32_t nearChild = node.leftOrFirst;
+		std::uint32_t farChild = node.countOrRight;
+		float tNear = IntersectAabb(m_Nodes[nearChild].min, m_Nodes[nearChild].max, origin, invDirection, tBest);
+		float tFar = IntersectAabb(m_Nodes[farChild].min, m_Nodes[farChild].max, origin, invDirection, tBest);
+		if (tFar < tNear)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(tNear, tFar);
+		}
+		if (tFar < tBest)
+			stack[stackSize++] = farChild;
+		if (tNear < tBest)
+			stack[stackSize++] = nearChild;
+	}
+
+	if (result.hit)
+	{
+		result.triangle = m_FacetIndices[result.triangle];
+		result.parameter = tBest;
+		result.point = origin + tBest * direction;
+	}
+	return result;
+}
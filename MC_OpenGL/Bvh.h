@@ -0,0 +1,56 @@
+#pragma once
+
+
+#include <cstdint>
+#include <vector>
+
+#include <glm.hpp>
+
+#include "TriangleStore.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	struct BvhHit
+	{
+		bool			hit			= false;
+		std::uint32_t	triangle	= 0;		// Facet index in the mesh, the store's order before Build.
+		float			parameter	= 0.f;		// Distance along the ray in units of the ray direction.
+		glm::vec3		point		= glm::vec3(0.f);
+	};
+
+
+	/// <summary> Bounding volume hierarchy over a TriangleStore, built with binned SAH. Building reorders the
+	/// 		  store so that every leaf covers a contiguous range of triangles; hits are mapped back to the
+	/// 		  original facet indices, so they line up with the index buffer and gl_PrimitiveID. </summary>
+	class Bvh
+	{
+	public:
+		Bvh() = default;
+
+		auto Build(TriangleStore& triangles) -> void;
+		auto Intersect(const TriangleView& triangles, const glm::vec3& origin, const glm::vec3& direction) const -> BvhHit;
+
+	private:
+		// Leaves have the top bit of countOrRight set and hold triangles [leftOrFirst, leftOrFirst + count).
+		// Interior nodes hold the indices of both children.
+		struct Node
+		{
+			glm::vec3		min;
+			std::uint32_t	leftOrFirst;
+			glm::vec3		max;
+			std::uint32_t	countOrRight;
+		};
+
+		struct BuildData;
+
+		auto BuildNode(BuildData& data, std::uint32_t first, std::uint32_t count, std::uint32_t depth, std::vector<Node>& nodes) -> void;
+
+		std::vector<Node>			m_Nodes;
+		std::vector<std::uint32_t>	m_FacetIndices;		// Facet index of every triangle in leaf order.
+	};
+
+
+}
@@ -19,7 +19,8 @@ MC_OpenGL::Camera::Camera()
 		m_Center(pointOrigin),
 		m_Up	(axisY),
 		m_Right	(axisX),
-		m_View	(glm::lookAt(axisZ, pointOrigin, axisY))
+		m_View	(glm::lookAt(axisZ, pointOrigin, axisY)),
+		m_InverseView(glm::inverse(m_View))
 {
 }
 
@@ -42,9 +43,17 @@ auto MC_OpenGL::Camera::DoArcballRotation(float angleX, float angleY) -> void
 }
 
 
+auto MC_OpenGL::Camera::InverseViewMatrix() const -> const glm::mat4&
+{
+	return m_InverseView;
+}
+
+
 auto MC_OpenGL::Camera::UpdateViewMatrix() -> void
 {
 	m_View = glm::lookAt(m_Eye, m_Center, m_Up);
+	m_InverseView = glm::inverse(m_View);
+	++m_Version;
 }
 
 
@@ -126,7 +135,13 @@ auto MC_OpenGL::Camera::SetViewTop() -> void
 }
 
 
-auto MC_OpenGL::Camera::ViewMatrix() const -> glm::mat4
+auto MC_OpenGL::Camera::Version() const -> std::uint64_t
+{
+	return m_Version;
+}
+
+
+auto MC_OpenGL::Camera::ViewMatrix() const -> const glm::mat4&
 {
 	return m_View;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 
+#include <cstdint>
+
 #include <glad/glad.h>
 
 #include <GLFW/glfw3.h>
@@ -19,6 +21,9 @@ namespace MC_OpenGL
 		Camera();
 
 		auto DoArcballRotation(float angleX, float angleY)	-> void;
+
+		/// <summary> Inverse of ViewMatrix(), computed when the view changes rather than on every use. </summary>
+		auto InverseViewMatrix() const						-> const glm::mat4&;
 		auto UpdateViewMatrix()								-> void;
 		auto SetViewIsometric()								-> void;
 		auto SetViewBack()									-> void;
@@ -27,7 +32,11 @@ namespace MC_OpenGL
 		auto SetViewLeft()									-> void;
 		auto SetViewRight()									-> void;
 		auto SetViewTop()									-> void;
-		auto ViewMatrix() const								-> glm::mat4;
+		auto ViewMatrix() const								-> const glm::mat4&;
+
+		/// <summary> Changes whenever the view matrix does, so that anything derived from it can tell when
+		/// 		  it is stale. </summary>
+		auto Version() const								-> std::uint64_t;
 
 	//private:
 		glm::vec3 m_Eye;
@@ -35,6 +44,8 @@ namespace MC_OpenGL
 		glm::vec3 m_Right;
 		glm::vec3 m_Up;
 		glm::mat4 m_View;
+		glm::mat4 m_InverseView;
+		std::uint64_t m_Version = 0;
 	};
 
 
@@ -0,0 +1,85 @@
+#include "CubeBatch.h"
+
+#include <cstddef>
+
+#include "Drawable.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "RenderDevice.h"
+
+
+auto MC_OpenGL::CubeBatch::Add(const glm::mat4& modelMatrix, const glm::vec3& color) -> void
+{
+	m_Instances.push_back({ modelMatrix, color });
+}
+
+
+auto MC_OpenGL::CubeBatch::Clear() -> void
+{
+	m_Instances.clear();
+}
+
+
+auto MC_OpenGL::CubeBatch::Draw() -> void
+{
+	MC_PROFILE_ZONE("CubeBatch::Draw");
+	if (!IsReady() || m_Instances.empty())
+		return;
+
+	// Orphan the old storage so the driver never stalls on a draw that still reads last frame's instances.
+	const GLsizeiptr size = static_cast<GLsizeiptr>(m_Instances.size() * sizeof(Instance));
+	Device().BindBuffer(GL_ARRAY_BUFFER, m_InstanceBuffer);
+	if (size > m_InstanceCapacity)
+		m_InstanceCapacity = 2 * size;
+	Device().BufferData(GL_ARRAY_BUFFER, m_InstanceCapacity, nullptr, GL_STREAM_DRAW);
+	Device().BufferSubData(GL_ARRAY_BUFFER, 0, size, m_Instances.data());
+	Device().BindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_Shader.Use();
+	GLState().BindVertexArray(m_Vao);
+	Device().DrawArraysInstanced(GL_TRIANGLES, 0, CubeVertexCount, static_cast<GLsizei>(m_Instances.size()));
+}
+
+
+auto MC_OpenGL::CubeBatch::Initialize(ShaderCompiler& shaders) -> void
+{
+	m_Shader = shaders.Submit(R"(..\shaders\vsInstancedLightColor.glsl)", R"(..\shaders\fsInstancedLightColor.glsl)");
+
+	m_Vao = Device().CreateVertexArray();
+	GLState().BindVertexArray(m_Vao);
+
+	Device().BindBuffer(GL_ARRAY_BUFFER, CubeMeshBuffer());
+	SetCubeVertexAttributes();
+
+	// A mat4 attribute takes four consecutive locations, one column each.
+	m_InstanceBuffer = Device().CreateBuffer();
+	Device().BindBuffer(GL_ARRAY_BUFFER, m_InstanceBuffer);
+	for (GLuint column = 0; column < 4; ++column)
+		Device().VertexAttribute(3 + column, 4, sizeof(Instance), offsetof(Instance, modelMatrix) + column * sizeof(glm::vec4), 1);
+	Device().VertexAttribute(7, 3, sizeof(Instance), offsetof(Instance, color), 1);
+
+	GLState().BindVertexArray(0);
+	Device().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+auto MC_OpenGL::CubeBatch::IsReady() const -> bool
+{
+	return m_Vao != 0 && static_cast<bool>(m_Shader);
+}
+
+
+auto MC_OpenGL::CubeBatch::Release() -> void
+{
+	Device().DeleteBuffer(m_InstanceBuffer);
+	GLState().DeleteVertexArray(m_Vao);
+	m_InstanceBuffer = 0;
+	m_InstanceCapacity = 0;
+	m_Vao = 0;
+}
+
+
+auto MC_OpenGL::CubeBatch::Size() const -> std::size_t
+{
+	return m_Instances.size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+#include "Shader.h"
+#include "ShaderCompiler.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Draws any number of unit cubes with one instanced call. Every instance shares the cube mesh
+	/// 		  from CubeMeshBuffer() and carries only its model matrix and color, which are streamed to the GPU
+	/// 		  once per Draw. Lit like fsBasicLightColor, from the FrameData block. </summary>
+	class CubeBatch
+	{
+	public:
+		CubeBatch() = default;
+		CubeBatch(const CubeBatch&) = delete;
+		auto operator=(const CubeBatch&) -> CubeBatch& = delete;
+
+		auto Initialize(ShaderCompiler& shaders) -> void;
+
+		/// <summary> False until the batch program is built, and for good if it fails; then the cubes have to
+		/// 		  be drawn one by one. </summary>
+		auto IsReady() const -> bool;
+
+		/// <summary> Delete the GL objects. Call while the context is still current. </summary>
+		auto Release() -> void;
+
+		auto Add(const glm::mat4& modelMatrix, const glm::vec3& color) -> void;
+		auto Clear() -> void;
+
+		/// <summary> Upload the instances added since the last Clear and draw them all. </summary>
+		auto Draw() -> void;
+		auto Size() const -> std::size_t;
+
+	private:
+		// Matches attributes 3 to 7 of vsInstancedLightColor.glsl.
+		struct Instance
+		{
+			glm::mat4	modelMatrix;
+			glm::vec3	color;
+		};
+
+		Shader					m_Shader;
+		GLuint					m_Vao					= 0;
+		GLuint					m_InstanceBuffer		= 0;
+		GLsizeiptr				m_InstanceCapacity		= 0;	// Bytes allocated in m_InstanceBuffer.
+		std::vector<Instance>	m_Instances;
+	};
+
+
+}
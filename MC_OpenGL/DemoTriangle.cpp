@@ -1,5 +1,8 @@
 #include "DemoTriangle.h"
 
+#include "GLState.h"
+#include "RenderDevice.h"
+
 
 MC_OpenGL::DemoTriangle::DemoTriangle ()
 {
@@ -59,30 +62,28 @@ MC_OpenGL::DemoTriangle::DemoTriangle ()
 		0.0f,  0.5f, 0.0f  // top   
 		};
 
-	unsigned int VBO;
-	glGenVertexArrays (1, &m_VAO);
-	glGenBuffers (1, &VBO);
+	m_VAO = Device ().CreateVertexArray ();
+	unsigned int VBO = Device ().CreateBuffer ();
 	// bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-	glBindVertexArray (m_VAO);
+	GLState ().BindVertexArray (m_VAO);
 
-	glBindBuffer (GL_ARRAY_BUFFER, VBO);
-	glBufferData (GL_ARRAY_BUFFER, sizeof (vertices), vertices, GL_STATIC_DRAW);
+	Device ().BindBuffer (GL_ARRAY_BUFFER, VBO);
+	Device ().BufferData (GL_ARRAY_BUFFER, sizeof (vertices), vertices, GL_STATIC_DRAW);
 
-	glVertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof (float), (void *)0);
-	glEnableVertexAttribArray (0);
+	Device ().VertexAttribute (0, 3, 3 * sizeof (float), 0);
 
 	// note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
-	glBindBuffer (GL_ARRAY_BUFFER, 0);
+	Device ().BindBuffer (GL_ARRAY_BUFFER, 0);
 
 	// You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
 	// VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-	glBindVertexArray (0);
+	GLState ().BindVertexArray (0);
 }
 
 
 auto MC_OpenGL::DemoTriangle::Draw () const -> void
 {
-	glUseProgram (m_ShaderProgram);
-	glBindVertexArray (m_VAO);
-	glDrawArrays (GL_TRIANGLES, 0, 3);		
+	GLState ().UseProgram (m_ShaderProgram);
+	GLState ().BindVertexArray (m_VAO);
+	Device ().DrawArrays (GL_TRIANGLES, 0, 3);		
 }
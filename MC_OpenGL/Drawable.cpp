@@ -1,9 +1,8 @@
 #include "Drawable.h"
 
+#include <cstdint>
 #include <iostream>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <limits>
 
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
@@ -12,52 +11,65 @@
 #include "Mathematics/Triangle.h"
 #include "Mathematics/Vector3.h"
 
-
-float MC_OpenGL::vertices[] = {
-	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-	0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-	0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-	0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-	0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-	-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-	-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-	0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-	0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-	0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-	0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+#include "GLState.h"
+#include "Profiler.h"
+#include "RenderDevice.h"
+#include "SceneIndex.h"
+#include "StlReader.h"
+
+
+namespace {
+
+
+// 3 vertex, 2 texture coords, 3 normal
+constexpr float cubeVertices[8 * MC_OpenGL::CubeVertexCount] = {
+	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f, 0.0f,  0.0f, -1.0f,
+	 0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f,  0.0f, -1.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  0.0f, -1.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  0.0f, -1.0f,
+	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  0.0f, -1.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f, 0.0f,  0.0f, -1.0f,
+
+	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+	 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f,
+	-0.5f,  0.5f,  0.5f,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+
+	-0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -1.0f,  0.0f,  0.0f,
+	-0.5f,  0.5f, -0.5f,  1.0f, 1.0f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, -1.0f,  0.0f,  0.0f,
+	-0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -1.0f,  0.0f,  0.0f,
+
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f,  0.0f,  0.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f,  0.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f,  0.0f,  0.0f,
+
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f, -1.0f,  0.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f, -1.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, -1.0f,  0.0f,
+
+	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  1.0f,  0.0f,
+	-0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  1.0f,  0.0f,
+	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  1.0f,  0.0f
 };
 
 
+}
+
+
 std::array<glm::vec3, 8> MC_OpenGL::boundingBox = {
 	glm::vec3(-0.5f, -0.5f, -0.5f),
 	glm::vec3(-0.5f, -0.5f,  0.5f),
@@ -84,221 +96,87 @@ std::vector<glm::vec3> MC_OpenGL::cubePositions = {
 };
 
 
-GLuint MC_OpenGL::vao;
-unsigned int MC_OpenGL::texture0;
-unsigned int MC_OpenGL::texture1;
-
-
-auto MC_OpenGL::InitDrawables() -> void
+auto MC_OpenGL::CubeMeshBuffer() -> GLuint
 {
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-
-	GLuint vbo;
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, 180 * sizeof(float), vertices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-
-	// START TEXTURE STUFF
-
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true);
-	unsigned char* data = stbi_load("..\\textures\\container.jpg", &width, &height, &nrChannels, 0);
-
-	glGenTextures(1, &texture0);
-	glBindTexture(GL_TEXTURE_2D, texture0);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	if (data)
+	static GLuint vbo = 0;
+	if (vbo == 0)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		vbo = Device().CreateBuffer();
+		Device().BindBuffer(GL_ARRAY_BUFFER, vbo);
+		Device().BufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
 	}
-	else
-	{
-		std::cerr << "Error: failed to load texture\n";
-		return;// static_cast<int>(MC_OpenGL::ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD);
-	}
-
-	stbi_image_free(data);
-
-	data = stbi_load("..\\textures\\juju.png", &width, &height, &nrChannels, 0);
-	glGenTextures(1, &texture1);
-	glBindTexture(GL_TEXTURE_2D, texture1);
+	return vbo;
+}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
+auto MC_OpenGL::CubeMeshVao() -> GLuint
+{
+	static GLuint vao = 0;
+	if (vao == 0)
 	{
-		std::cerr << "Error: failed to load texture\n";
-		return;// static_cast<int>(MC_OpenGL::ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD);
+		vao = Device().CreateVertexArray();
+		GLState().BindVertexArray(vao);
+		Device().BindBuffer(GL_ARRAY_BUFFER, CubeMeshBuffer());
+		SetCubeVertexAttributes();
+		GLState().BindVertexArray(0);
 	}
-
-	stbi_image_free(data);
+	return vao;
 }
 
 
-MC_OpenGL::WoodenBox::WoodenBox (const glm::mat4 &modelMatrix)
-	: Cube(Shader(R"(..\shaders\vsContainer.glsl)", R"(..\shaders\fsContainer.glsl)"), modelMatrix, DrawableType::WoodenBox)
-	{
-	// START TEXTURE STUFF
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load (true);
-	unsigned char *data = stbi_load ("..\\textures\\container.jpg", &width, &height, &nrChannels, 0);
+auto MC_OpenGL::SetCubeVertexAttributes() -> void
+{
+	Device().VertexAttribute(0, 3, 8 * sizeof(float), 0);
+	Device().VertexAttribute(1, 2, 8 * sizeof(float), 3 * sizeof(float));
+	Device().VertexAttribute(2, 3, 8 * sizeof(float), 5 * sizeof(float));
+}
 
-	glGenTextures (1, &texture0);
-	glBindTexture (GL_TEXTURE_2D, texture0);
 
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+MC_OpenGL::WoodenBox::WoodenBox (ShaderCompiler &shaders, TextureManager &textures, const glm::mat4 &modelMatrix)
+	: Cube(shaders.Submit(R"(..\shaders\vsContainer.glsl)", R"(..\shaders\fsContainer.glsl)"), modelMatrix, DrawableType::WoodenBox)
+	{
+	m_Container = textures.Load ("..\\textures\\container.jpg");
+	m_AwesomeFace = textures.Load ("..\\textures\\juju.png");
+	}
 
-	if (data)
-		{
-		glTexImage2D (GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap (GL_TEXTURE_2D);
-		}
-	else
+	auto MC_OpenGL::WoodenBox::Draw (const glm::vec3 &color) const -> void
 		{
-		std::cerr << "Error: failed to load texture\n";
-		return;// static_cast<int>(MC_OpenGL::ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD);
-		}
+		MC_PROFILE_ZONE ("WoodenBox::Draw");
+		if (!UseShader (color))
+			return;
 
-	stbi_image_free (data);
+		GLState ().BindVertexArray (m_Vao);
 
-	data = stbi_load ("..\\textures\\juju.png", &width, &height, &nrChannels, 0);
-	glGenTextures (1, &texture1);
-	glBindTexture (GL_TEXTURE_2D, texture1);
+		m_Container.Bind (0);
+		m_AwesomeFace.Bind (1);
 
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		m_MixPercentageUniform.Set (0.f);
 
-	if (data)
-		{
-		glTexImage2D (GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap (GL_TEXTURE_2D);
-		}
-	else
-		{
-		std::cerr << "Error: failed to load texture\n";
-		return;// static_cast<int>(MC_OpenGL::ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD);
+		Device ().DrawArrays (GL_TRIANGLES, 0, CubeVertexCount);
 		}
 
-	stbi_image_free (data);
-	}
-
-	auto MC_OpenGL::WoodenBox::Draw (const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix) const -> void
+	auto MC_OpenGL::WoodenBox::GetMaterial () const -> GLuint
+		{
+		return m_Container ? m_Container.image->id : 0;
+		}
+
+	auto MC_OpenGL::WoodenBox::ResolveUniforms () const -> void
 		{
-		glUseProgram(m_ShaderId);
-
-		glBindVertexArray (m_Vao);
+		Cube::ResolveUniforms ();
 
-		glActiveTexture (GL_TEXTURE0);
-		glBindTexture (GL_TEXTURE_2D, MC_OpenGL::texture0);
-
-		glActiveTexture (GL_TEXTURE1);
-		glBindTexture (GL_TEXTURE_2D, MC_OpenGL::texture1);
-
-		glUniform1i (glGetUniformLocation (m_ShaderId, "samplerContainer"), 0);
-		glUniform1i (glGetUniformLocation (m_ShaderId, "samplerAwesomeFace"), 1);
-
-		glUniform1f (glGetUniformLocation (m_ShaderId, "mixPercentage"), 0.f);
-
-		glUniformMatrix4fv (glGetUniformLocation (m_ShaderId, "model"), 1, GL_FALSE, glm::value_ptr (m_ModelMatrix));
-		glUniformMatrix4fv (glGetUniformLocation (m_ShaderId, "view"), 1, GL_FALSE, glm::value_ptr (viewMatrix));
-		glUniformMatrix4fv (glGetUniformLocation (m_ShaderId, "projection"), 1, GL_FALSE, glm::value_ptr (projectionMatrix));
-
-		glDrawArrays (GL_TRIANGLES, 0, 36);
+		// The texture units never change, so they are set once rather than every draw.
+		m_Shader.GetUniform<int> ("samplerContainer").Set (0);
+		m_Shader.GetUniform<int> ("samplerAwesomeFace").Set (1);
+		m_MixPercentageUniform = m_Shader.GetUniform<float> ("mixPercentage");
 		}
 
 
-	MC_OpenGL::Cube::Cube(GLuint shaderId, const glm::mat4& modelMatrix, DrawableType type)
-		: Drawable(shaderId, type)
+	MC_OpenGL::Cube::Cube(const Shader& shader, const glm::mat4& modelMatrix, DrawableType type)
+		: Drawable(shader, type)
 	{
 		m_ModelMatrix = modelMatrix;
 
-		float vertices[288] = { // 3 vertex, 2 texture coords, 3 normal
-			-0.5f, -0.5f, -0.5f,  0.0f, 0.0f, 0.0f,  0.0f, -1.0f,
-			 0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f,  0.0f, -1.0f,
-			 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  0.0f, -1.0f,
-			 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  0.0f, -1.0f,
-			-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  0.0f, -1.0f,
-			-0.5f, -0.5f, -0.5f,  0.0f, 0.0f, 0.0f,  0.0f, -1.0f,
-
-			-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
-			 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  0.0f, 1.0f,
-			 0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f,
-			 0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f,
-			-0.5f,  0.5f,  0.5f,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
-			-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
-
-			-0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -1.0f,  0.0f,  0.0f,
-			-0.5f,  0.5f, -0.5f,  1.0f, 1.0f, -1.0f,  0.0f,  0.0f,
-			-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, -1.0f,  0.0f,  0.0f,
-			-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, -1.0f,  0.0f,  0.0f,
-			-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, -1.0f,  0.0f,  0.0f,
-			-0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -1.0f,  0.0f,  0.0f,
-
-			 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f,  0.0f,  0.0f,
-			 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 1.0f,  0.0f,  0.0f,
-			 0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  0.0f,  0.0f,
-			 0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  0.0f,  0.0f,
-			 0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f,  0.0f,  0.0f,
-			 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f,  0.0f,  0.0f,
-
-			-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, -1.0f,  0.0f,
-			 0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 0.0f, -1.0f,  0.0f,
-			 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f, -1.0f,  0.0f,
-			 0.5f, -0.5f,  0.5f,  1.0f, 0.0f, 0.0f, -1.0f,  0.0f,
-			-0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 0.0f, -1.0f,  0.0f,
-			-0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, -1.0f,  0.0f,
-
-			-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  1.0f,  0.0f,
-			 0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f,  1.0f,  0.0f,
-			 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  1.0f,  0.0f,
-			 0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.0f,  1.0f,  0.0f,
-			-0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 0.0f,  1.0f,  0.0f,
-			-0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f,  1.0f,  0.0f
-		};
-
-		glGenVertexArrays(1, &m_Vao);
-		glBindVertexArray(m_Vao);
-
-		GLuint vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, 288 * sizeof(float), vertices, GL_STATIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-		glEnableVertexAttribArray(2);
+		m_Vao = CubeMeshVao();
 
 		m_BoundingBox = std::array<glm::vec3, 8>
 		{
@@ -314,35 +192,47 @@ MC_OpenGL::WoodenBox::WoodenBox (const glm::mat4 &modelMatrix)
 	}
 
 
-	auto MC_OpenGL::Cube::Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const -> void
+	auto MC_OpenGL::Cube::Draw(const glm::vec3& color) const -> void
 	{
-		glUseProgram(m_ShaderId);
-
-		glBindVertexArray(m_Vao);
+		MC_PROFILE_ZONE("Cube::Draw");
+		if (UseShader(color))
+			DrawMesh();
+	}
 
-		glUniformMatrix4fv(glGetUniformLocation(m_ShaderId, "model"), 1, GL_FALSE, glm::value_ptr(m_ModelMatrix));
-		glUniformMatrix4fv(glGetUniformLocation(m_ShaderId, "view"), 1, GL_FALSE, glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(glGetUniformLocation(m_ShaderId, "projection"), 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+	auto MC_OpenGL::Cube::DrawMesh() const -> void
+	{
+		GLState().BindVertexArray(m_Vao);
+		Device().DrawArrays(GL_TRIANGLES, 0, CubeVertexCount);
 	}
 
-	auto MC_OpenGL::Cube::BoundingBox () const -> std::array<glm::vec3, 8>
-		{
-		return m_BoundingBox;
-		}
-
 
-	auto MC_OpenGL::Cube::ModelMatrix () const -> glm::mat4
-		{
-		return m_ModelMatrix;
-		}
+	auto MC_OpenGL::Cube::GetVao() const -> GLuint
+	{
+		return m_Vao;
+	}
 
 
-	MC_OpenGL::Drawable::Drawable(GLuint shaderId, DrawableType type)
-		:	m_ShaderId(shaderId),
-			m_Type(type)
+	MC_OpenGL::Drawable::Drawable(const Shader& shader, DrawableType type)
+		:	m_Type(type),
+			m_Shader(shader)
 	{
+	}
+
+
+	auto MC_OpenGL::Drawable::BoundingBox() const -> const std::array<glm::vec3, 8>&
+	{
+		return m_BoundingBox;
+	}
+
+
+	auto MC_OpenGL::Drawable::BoundingSphere(glm::vec3& center, float& radius) const -> void
+	{
+		if (m_WorldBoundsDirty)
+			UpdateWorldBounds();
+
+		center = 0.5f * (m_WorldMin + m_WorldMax);
+		radius = 0.5f * glm::length(m_WorldMax - m_WorldMin);
 	}
 
 
@@ -358,17 +248,47 @@ MC_OpenGL::WoodenBox::WoodenBox (const glm::mat4 &modelMatrix)
 	}
 
 
+	auto MC_OpenGL::Drawable::GetMaterial() const -> GLuint
+	{
+		return 0;
+	}
+
+
+	auto MC_OpenGL::Drawable::GetSceneProxy() const -> std::int32_t
+	{
+		return m_SceneProxy;
+	}
+
+
 	auto MC_OpenGL::Drawable::GetSelected() const -> bool
 	{
 		return m_Selected;
 	}
 
+	auto MC_OpenGL::Drawable::GetShaderId() const -> GLuint
+	{
+		return m_Shader.GetProgramId();
+	}
+
 	auto MC_OpenGL::Drawable::GetType() const -> DrawableType
 	{
 		return m_Type;
 	}
 
 
+	auto MC_OpenGL::Drawable::ModelMatrix() const -> const glm::mat4&
+	{
+		return m_ModelMatrix;
+	}
+
+
+	auto MC_OpenGL::Drawable::ResolveUniforms() const -> void
+	{
+		m_ModelUniform = m_Shader.GetUniform<glm::mat4>("model");
+		m_ObjectColorUniform = m_Shader.GetUniform<glm::vec3>("objectColor");
+	}
+
+
 	auto MC_OpenGL::Drawable::SetColor(const glm::vec3& rgb) -> void
 	{
 		m_Color = rgb;
@@ -384,82 +304,80 @@ MC_OpenGL::WoodenBox::WoodenBox (const glm::mat4 &modelMatrix)
 	auto MC_OpenGL::Drawable::SetModel(const glm::mat4& model) -> void
 	{
 		m_ModelMatrix = model;
+		m_WorldBoundsDirty = true;
+		if (m_SceneIndex != nullptr)
+			m_SceneIndex->Update(this);
+	}
+
+
+	auto MC_OpenGL::Drawable::SetSceneProxy(SceneIndex* sceneIndex, std::int32_t proxy) -> void
+	{
+		m_SceneIndex = sceneIndex;
+		m_SceneProxy = proxy;
 	}
 
 
 	auto MC_OpenGL::Drawable::SetSelected(bool selected) -> void
 	{
 		m_Selected = selected;
-	}
+	}
 
 
-	MC_OpenGL::Triangles::Triangles(const Shader& shader, const std::string& stl)
-		: Drawable(shader, DrawableType::Triangles)
+	auto MC_OpenGL::Drawable::UseShader(const glm::vec3& color) const -> bool
 	{
-		m_Shader = shader;//Shader(R"(..\shaders\vsBasicCoordinateSystems.glsl)", R"(..\shaders\fsBasicCoordinateSystems.glsl)");
-		m_ModelMatrix = glm::mat4(1.f);
+		if (!m_Shader)
+			return false;
 
-		std::vector<float> vertices;
-
-		std::ifstream ifs(stl);
-		std::string line;
-		while (std::getline(ifs, line))
+		m_Shader.Use();
+		if (!m_UniformsResolved)
 		{
-			std::stringstream ss(line);
-			std::string firstWord;
-			ss >> firstWord;
-			std::array<float, 3> normal;
-			if (firstWord == "facet")
-			{
-				ss >> firstWord >> normal[0] >> normal[1] >> normal[2];
-			}
-			if (firstWord == "vertex")
-			{
-				float x;
-				float y;
-				float z;
-				ss >> x >> y >> z;
-
-				vertices.push_back(x);
-				vertices.push_back(y);
-				vertices.push_back(z);
-				vertices.push_back(0.f);
-				vertices.push_back(0.f);
-				vertices.push_back(normal[0]);
-				vertices.push_back(normal[1]);
-				vertices.push_back(normal[2]);
-			}
+			ResolveUniforms();
+			m_UniformsResolved = true;
 		}
-		m_NumVertices = vertices.size() / 8.f;
+		m_ModelUniform.Set(m_ModelMatrix);
+		m_ObjectColorUniform.Set(color);
+		return true;
+	}
 
-		int count = 0;
-		for (int i = 0; i < vertices.size(); i += 24)
-		{
-			count++;
-			gte::Triangle3<float> tri(
-				gte::Vector3<float>({ vertices[i], vertices[i + 1], vertices[i + 2] }),
-				gte::Vector3<float>({ vertices[i + 8], vertices[i + 9], vertices[i + 10] }),
-				gte::Vector3<float>({ vertices[i + 16], vertices[i + 17], vertices[i + 18] })
-			);
-
-			m_Triangles.push_back(tri);
-		}
 
-		float x0 = std::numeric_limits<float>::max();
-		float y0 = std::numeric_limits<float>::max();
-		float z0 = std::numeric_limits<float>::max();
-		float x1 = std::numeric_limits<float>::lowest();
-		float y1 = std::numeric_limits<float>::lowest();
-		float z1 = std::numeric_limits<float>::lowest();
-		for (int i = 0; i < vertices.size(); i += 8)
+	auto MC_OpenGL::Drawable::UpdateWorldBounds() const -> void
+	{
+		m_WorldMin = glm::vec3(std::numeric_limits<float>::max());
+		m_WorldMax = glm::vec3(std::numeric_limits<float>::lowest());
+		for (const glm::vec3& corner : m_BoundingBox)
 		{
-			x0 = std::min(x0, vertices[i]);
-			y0 = std::min(y0, vertices[i + 1]);
-			x1 = std::max(x1, vertices[i]);
-			y1 = std::max(y1, vertices[i + 1]);
-			z0 = std::min(z0, vertices[i + 2]);
-			z1 = std::max(z1, vertices[i + 2]);
+			glm::vec3 ptWorldSpace = m_ModelMatrix * glm::vec4(corner, 1.f);
+			m_WorldMin = glm::min(m_WorldMin, ptWorldSpace);
+			m_WorldMax = glm::max(m_WorldMax, ptWorldSpace);
 		}
+		m_WorldBoundsDirty = false;
+	}
+
+
+	auto MC_OpenGL::Drawable::WorldBounds(glm::vec3& min, glm::vec3& max) const -> void
+	{
+		if (m_WorldBoundsDirty)
+			UpdateWorldBounds();
+
+		min = m_WorldMin;
+		max = m_WorldMax;
+	}
+
+
+	MC_OpenGL::Triangles::Triangles(const Shader& shader, GeometryRegistry& geometry, const std::string& stl)
+		: Drawable(shader, DrawableType::Triangles)
+	{
+		MC_PROFILE_ZONE("Triangles::Triangles");
+		m_ModelMatrix = glm::mat4(1.f);
+
+		m_Mesh = geometry.LoadStl(stl);
+
+		float x0 = m_Mesh->boundsMin.x;
+		float y0 = m_Mesh->boundsMin.y;
+		float z0 = m_Mesh->boundsMin.z;
+		float x1 = m_Mesh->boundsMax.x;
+		float y1 = m_Mesh->boundsMax.y;
+		float z1 = m_Mesh->boundsMax.z;
 		m_BoundingBox = std::array<glm::vec3, 8>{
 			glm::vec3(x0, y0, z0),
 				glm::vec3(x0, y0, z1),
@@ -470,54 +388,46 @@ MC_OpenGL::WoodenBox::WoodenBox (const glm::mat4 &modelMatrix)
 				glm::vec3(x1, y1, z0),
 				glm::vec3(x1, y1, z1)
 		};
-
-		glGenVertexArrays(1, &m_Vao);
-		glBindVertexArray(m_Vao);
-
-		glGenBuffers(1, &m_Vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_Vbo);
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-		glEnableVertexAttribArray(2);
 	}
 
 
-	auto MC_OpenGL::Triangles::Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const -> void
+	auto MC_OpenGL::Triangles::Draw(const glm::vec3& color) const -> void
 	{
-		m_Shader.Use();
+		MC_PROFILE_ZONE("Triangles::Draw");
+		if (UseShader(color))
+			DrawMesh();
+	}
 
-		glUniformMatrix4fv(glGetUniformLocation(m_Shader.GetProgramId(), "model"), 1, GL_FALSE, glm::value_ptr(m_ModelMatrix));
-		glUniformMatrix4fv(glGetUniformLocation(m_Shader.GetProgramId(), "view"), 1, GL_FALSE, glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(glGetUniformLocation(m_Shader.GetProgramId(), "projection"), 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
-		glBindVertexArray(m_Vao);
-		if (m_Indices.empty())
-			glDrawArrays(GL_TRIANGLES, 0, m_NumVertices);
+	auto MC_OpenGL::Triangles::DrawMesh() const -> void
+	{
+		GLState().BindVertexArray(m_Mesh->vao);
+		if (m_Mesh->numIndices == 0)
+			Device().DrawArrays(GL_TRIANGLES, 0, m_Mesh->numVertices);
 		else
-			glDrawElements(GL_TRIANGLES, m_NumVertices, GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+			Device().DrawElements(GL_TRIANGLES, m_Mesh->numIndices, m_Mesh->indexType, 0);
 	}
 
 
-	auto MC_OpenGL::Triangles::GetTriangles() const -> std::vector<gte::Triangle3<float>>
+	auto MC_OpenGL::Triangles::GetTriangles() const -> TriangleView
 	{
-		return m_Triangles;
+		return m_Mesh->triangles.View();
 	}
 
 
-	auto MC_OpenGL::Triangles::ModelMatrix() const -> glm::mat4
+	auto MC_OpenGL::Triangles::GetVao() const -> GLuint
 	{
-		return m_ModelMatrix;
+		return m_Mesh->vao;
 	}
 
-	auto MC_OpenGL::Triangles::BoundingBox() const -> std::array<glm::vec3, 8>
+
+	auto MC_OpenGL::Triangles::Intersect(const glm::vec3& origin, const glm::vec3& direction) const -> BvhHit
 	{
-		return m_BoundingBox;
+		MC_PROFILE_ZONE("Triangles::Intersect");
+		// Intersect in model space. The direction is not renormalized, so the hit parameter is still a world space distance.
+		glm::mat4 worldToModel = glm::inverse(m_ModelMatrix);
+		BvhHit hit = m_Mesh->bvh.Intersect(m_Mesh->triangles.View(), glm::vec3(worldToModel * glm::vec4(origin, 1.f)), glm::vec3(worldToModel * glm::vec4(direction, 0.f)));
+		if (hit.hit)
+			hit.point = glm::vec3(m_ModelMatrix * glm::vec4(hit.point, 1.f));
+		return hit;
 	}
@@ -2,6 +2,7 @@
 
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
@@ -10,13 +11,21 @@
 
 #include <Mathematics/Triangle.h>
 
+#include "Bvh.h"
+#include "GeometryRegistry.h"
 #include "Shader.h"
+#include "ShaderCompiler.h"
+#include "TextureManager.h"
+#include "TriangleStore.h"
 
 
 namespace MC_OpenGL
 {
 
 
+	class SceneIndex;
+
+
 	enum class DrawableType
 	{
 		Cube,
@@ -28,88 +37,143 @@ namespace MC_OpenGL
 	class Drawable
 		{
 		public:
-			Drawable(GLuint shaderId, DrawableType drawableType);
+			Drawable(const Shader& shader, DrawableType drawableType);
+
+			/// <summary> Draw with the drawable's own program, in color if the program has an objectColor.
+			/// 		  View and projection come from the FrameData block, so only per-object uniforms are set
+			/// 		  here. Draws nothing while the program is still being built. </summary>
+			virtual auto Draw (const glm::vec3 &color) const -> void = 0;
+
+			/// <summary> Issue the draw call for the geometry only, using whatever program is bound. For
+			/// 		  passes such as ID picking that set up their own shader. </summary>
+			virtual auto DrawMesh() const -> void = 0;
+
+			/// <summary> Corners of the model space bounding box. </summary>
+			auto BoundingBox() const -> const std::array<glm::vec3, 8>&;
 
-			virtual auto Draw (const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix) const -> void = 0;
-			virtual auto BoundingBox () const -> std::array<glm::vec3, 8> = 0;
-			virtual auto ModelMatrix() const -> glm::mat4 = 0;
+			/// <summary> World space sphere around WorldBounds(). Cached like WorldBounds(). </summary>
+			auto BoundingSphere(glm::vec3& center, float& radius) const -> void;
+			auto ModelMatrix() const -> const glm::mat4&;
+
+			/// <summary> Axis aligned box around the model space bounding box corners in world space.
+			/// 		  Computed on first use after a SetModel call, a lookup otherwise. </summary>
+			auto WorldBounds(glm::vec3& min, glm::vec3& max) const -> void;
 
 			auto GetColor() const -> glm::vec3;
 			auto GetHover() const -> bool;
+
+			/// <summary> Texture, or other material state, the drawable binds; 0 for none. For sorting
+			/// 		  draws only. </summary>
+			virtual auto GetMaterial() const -> GLuint;
+			auto GetSceneProxy() const -> std::int32_t;
 			auto GetSelected() const -> bool;
+			auto GetShaderId() const -> GLuint;
 			auto GetType() const -> DrawableType;
+			virtual auto GetVao() const -> GLuint = 0;
 			auto SetColor(const glm::vec3& rgb) -> void;
 			auto SetHover(bool hover) -> void;
 			auto SetModel(const glm::mat4 &model) -> void;
 			auto SetSelected(bool selected) -> void;
 
+			/// <summary> Set by SceneIndex when the drawable is inserted or removed, so that SetModel can
+			/// 		  keep the index up to date. </summary>
+			auto SetSceneProxy(SceneIndex* sceneIndex, std::int32_t proxy) -> void;
+
 		protected:
 			DrawableType m_Type = DrawableType::Cube;
+			std::array<glm::vec3, 8> m_BoundingBox = std::array<glm::vec3, 8>();
 			glm::vec3 m_Color = glm::vec3(0.f, 0.f, 1.f);
 			bool m_Hover = false;
 			glm::mat4 m_ModelMatrix = glm::mat4(1.f);
 			bool m_Selected = false;
-			GLuint m_ShaderId = 0;
+			Shader m_Shader;
+			mutable Uniform<glm::mat4> m_ModelUniform;
+			mutable Uniform<glm::vec3> m_ObjectColorUniform;
+			SceneIndex* m_SceneIndex = nullptr;
+			std::int32_t m_SceneProxy = -1;
+
+			/// <summary> Look up the uniform handles. Called by UseShader the first time the program is
+			/// 		  ready, with the program in use. </summary>
+			virtual auto ResolveUniforms() const -> void;
+
+			/// <summary> Use the drawable's program and set its model matrix and color. False, doing nothing,
+			/// 		  while the program is not ready. </summary>
+			auto UseShader(const glm::vec3& color) const -> bool;
+
+		private:
+			mutable bool m_UniformsResolved = false;
+
+			auto UpdateWorldBounds() const -> void;
+
+			// Derived from m_BoundingBox and m_ModelMatrix; constructors set both before anything asks.
+			mutable bool m_WorldBoundsDirty = true;
+			mutable glm::vec3 m_WorldMin = glm::vec3(0.f);
+			mutable glm::vec3 m_WorldMax = glm::vec3(0.f);
 		};
 
 
 	class Cube : public Drawable
 	{
 	public:
-		Cube(GLuint shaderId, const glm::mat4& modelMatrix, DrawableType type = DrawableType::Cube);
+		Cube(const Shader& shader, const glm::mat4& modelMatrix, DrawableType type = DrawableType::Cube);
 
-		virtual auto Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const -> void;
-
-		auto BoundingBox() const->std::array<glm::vec3, 8>;
-		auto ModelMatrix() const->glm::mat4;
+		virtual auto Draw(const glm::vec3& color) const -> void;
+		auto DrawMesh() const -> void;
+		auto GetVao() const -> GLuint;
 
 	protected:
 		GLuint						m_Vao			= 0;
-		std::array<glm::vec3, 8>	m_BoundingBox	= std::array<glm::vec3, 8>();
 	};
 
 
 	class Triangles : public Drawable
 	{
 	public:
-		Triangles(const Shader& shader, const std::string& stl);
+		/// <summary> The mesh comes from the registry, so loading the same STL again shares its buffers. </summary>
+		Triangles(const Shader& shader, GeometryRegistry& geometry, const std::string& stl);
 
-		auto BoundingBox() const -> std::array<glm::vec3, 8>;
-		auto Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const -> void;
-		auto GetTriangles() const ->std::vector<gte::Triangle3<float> >;
-		auto ModelMatrix() const -> glm::mat4;
+		auto Draw(const glm::vec3& color) const -> void;
+		auto DrawMesh() const -> void;
+		/// <summary> The triangles in the Bvh's leaf order, not the facet order of the STL. </summary>
+		auto GetTriangles() const -> TriangleView;
+		auto GetVao() const -> GLuint;
+		auto Intersect(const glm::vec3& origin, const glm::vec3& direction) const -> BvhHit;
 
 	private:
-		glm::mat4							m_ModelMatrix;
-		Shader								m_Shader;
-		std::array<glm::vec3, 8>			m_BoundingBox;
-		std::vector<int>					m_Indices;
-		std::vector<float>					m_Vertices;
-		std::vector<gte::Triangle3<float> >	m_Triangles;
-		GLuint m_NumVertices;
-		GLuint m_Vao = 0;
-		GLuint m_Vbo = 0;
-		GLuint m_Ebo = 0;
+		MeshHandle							m_Mesh;
 	};
 
 
 	class WoodenBox : public Cube
 		{
 		public:
-			WoodenBox (const glm::mat4 &modelMatrix);
+			WoodenBox (ShaderCompiler &shaders, TextureManager &textures, const glm::mat4 &modelMatrix);
+
+			auto Draw (const glm::vec3 &color) const -> void;
+			auto GetMaterial () const -> GLuint;
 
-			auto Draw (const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix) const -> void;
+		protected:
+			auto ResolveUniforms () const -> void;
+
+		private:
+			Texture m_Container;
+			Texture m_AwesomeFace;
+			mutable Uniform<float> m_MixPercentageUniform;
 		};
 
 
-	auto InitDrawables() -> void;
+	constexpr GLsizei CubeVertexCount = 36;
+
+	/// <summary> The unit cube every Cube draws: CubeVertexCount vertices of position (3), texture coords (2)
+	/// 		  and normal (3). One vertex buffer and one vertex array, created on first use. </summary>
+	auto CubeMeshBuffer() -> GLuint;
+	auto CubeMeshVao() -> GLuint;
+
+	/// <summary> Point attributes 0-2 at the cube layout in the bound GL_ARRAY_BUFFER. </summary>
+	auto SetCubeVertexAttributes() -> void;
 
-	extern float vertices[];
-	extern GLuint vao;
 	extern std::array<glm::vec3, 8> boundingBox;
 	extern std::vector<glm::vec3> cubePositions;
-	extern unsigned int texture0;
-	extern unsigned int texture1;
 
 
 }
@@ -11,7 +11,11 @@ enum class ErrorCode
 	ERROR_GLAD_LOAD_GL_LOADER,
 	ERROR_GLFW_CREATE_WINDOW,
 	ERROR_GLFW_WINDOW_IS_NULL,
+	ERROR_PICK_FRAMEBUFFER_INCOMPLETE,
 	ERROR_SHADER_PROGRAM_LINKING_FAILED,
+	ERROR_STL_FAILED_TO_LOAD,
+	ERROR_TEXTURE_CACHE_INVALID,
+	ERROR_TEXTURE_CACHE_WRITE_FAILED,
 	ERROR_TEXTURE_FAILED_TO_LOAD,
 	ERROR_VERTEX_SHADER_COMPILATION_FAILED
 	};
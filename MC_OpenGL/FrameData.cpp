@@ -0,0 +1,31 @@
+#include "FrameData.h"
+
+#include "RenderDevice.h"
+
+
+auto MC_OpenGL::FrameUniformBuffer::Initialize() -> void
+{
+	m_Buffer = Device().CreateBuffer();
+	Device().BindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+	Device().BufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+	Device().BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	Device().BindBufferBase(GL_UNIFORM_BUFFER, FrameDataBinding, m_Buffer);
+}
+
+
+auto MC_OpenGL::FrameUniformBuffer::Release() -> void
+{
+	Device().DeleteBuffer(m_Buffer);
+	m_Buffer = 0;
+}
+
+
+auto MC_OpenGL::FrameUniformBuffer::Update(const FrameData& frameData) -> void
+{
+	// Orphan the storage so the write never waits on last frame's draws.
+	Device().BindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+	Device().BufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+	Device().BufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frameData);
+	Device().BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Uniform buffer binding point of the FrameData block. Shader binds every program that
+	/// 		  declares the block to it after linking. </summary>
+	constexpr GLuint FrameDataBinding = 0;
+	constexpr const char* FrameDataBlockName = "FrameData";
+
+
+	/// <summary> The std140 layout of the FrameData uniform block in the shaders: everything that is the same
+	/// 		  for every draw in a frame. A vec3 takes a whole 16 byte slot. </summary>
+	struct FrameData
+	{
+		glm::mat4	view			= glm::mat4(1.f);
+		glm::mat4	projection		= glm::mat4(1.f);
+		glm::vec3	viewPos			= glm::vec3(0.f);
+		float		padding0		= 0.f;
+		glm::vec3	lightColor		= glm::vec3(1.f);
+		float		padding1		= 0.f;
+	};
+
+	static_assert(sizeof(FrameData) == 160, "FrameData must match the std140 block");
+
+
+	/// <summary> The uniform buffer behind the FrameData block, written once per frame. </summary>
+	class FrameUniformBuffer
+	{
+	public:
+		FrameUniformBuffer() = default;
+		FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+		auto operator=(const FrameUniformBuffer&) -> FrameUniformBuffer& = delete;
+
+		auto Initialize() -> void;
+
+		/// <summary> Delete the buffer. Call while the context is still current. </summary>
+		auto Release() -> void;
+		auto Update(const FrameData& frameData) -> void;
+
+	private:
+		GLuint m_Buffer = 0;
+	};
+
+
+}
@@ -0,0 +1,187 @@
+#include "GLDevice.h"
+
+#include <gtc/type_ptr.hpp>
+
+
+auto MC_OpenGL::GLDevice::ActiveTexture(GLuint unit) -> void
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+
+auto MC_OpenGL::GLDevice::BindBuffer(GLenum target, GLuint buffer) -> void
+{
+	glBindBuffer(target, buffer);
+}
+
+
+auto MC_OpenGL::GLDevice::BindBufferBase(GLenum target, GLuint index, GLuint buffer) -> void
+{
+	glBindBufferBase(target, index, buffer);
+}
+
+
+auto MC_OpenGL::GLDevice::BindSampler(GLuint unit, GLuint sampler) -> void
+{
+	glBindSampler(unit, sampler);
+}
+
+
+auto MC_OpenGL::GLDevice::BindTexture(GLuint texture) -> void
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+
+auto MC_OpenGL::GLDevice::BindVertexArray(GLuint vao) -> void
+{
+	glBindVertexArray(vao);
+}
+
+
+auto MC_OpenGL::GLDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void
+{
+	glBufferData(target, size, data, usage);
+}
+
+
+auto MC_OpenGL::GLDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void
+{
+	glBufferSubData(target, offset, size, data);
+}
+
+
+auto MC_OpenGL::GLDevice::Clear(GLbitfield mask) -> void
+{
+	glClear(mask);
+}
+
+
+auto MC_OpenGL::GLDevice::ClearColor(float r, float g, float b, float a) -> void
+{
+	glClearColor(r, g, b, a);
+}
+
+
+auto MC_OpenGL::GLDevice::CreateBuffer() -> GLuint
+{
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	return buffer;
+}
+
+
+auto MC_OpenGL::GLDevice::CreateVertexArray() -> GLuint
+{
+	GLuint vao = 0;
+	glGenVertexArrays(1, &vao);
+	return vao;
+}
+
+
+auto MC_OpenGL::GLDevice::DeleteBuffer(GLuint buffer) -> void
+{
+	if (buffer != 0)
+		glDeleteBuffers(1, &buffer);
+}
+
+
+auto MC_OpenGL::GLDevice::DeleteTexture(GLuint texture) -> void
+{
+	if (texture != 0)
+		glDeleteTextures(1, &texture);
+}
+
+
+auto MC_OpenGL::GLDevice::DeleteVertexArray(GLuint vao) -> void
+{
+	if (vao != 0)
+		glDeleteVertexArrays(1, &vao);
+}
+
+
+auto MC_OpenGL::GLDevice::Disable(GLenum capability) -> void
+{
+	glDisable(capability);
+}
+
+
+auto MC_OpenGL::GLDevice::DrawArrays(GLenum mode, GLint first, GLsizei count) -> void
+{
+	glDrawArrays(mode, first, count);
+}
+
+
+auto MC_OpenGL::GLDevice::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void
+{
+	glDrawArraysInstanced(mode, first, count, instances);
+}
+
+
+auto MC_OpenGL::GLDevice::DrawElements(GLenum mode, GLsizei count, GLenum type, std::size_t offset) -> void
+{
+	glDrawElements(mode, count, type, reinterpret_cast<const void*>(offset));
+}
+
+
+auto MC_OpenGL::GLDevice::Enable(GLenum capability) -> void
+{
+	glEnable(capability);
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, float value) -> void
+{
+	glUniform1f(location, value);
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, int value) -> void
+{
+	glUniform1i(location, value);
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, GLuint value) -> void
+{
+	glUniform1ui(location, value);
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, const glm::vec3& value) -> void
+{
+	glUniform3fv(location, 1, glm::value_ptr(value));
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, const glm::vec4& value) -> void
+{
+	glUniform4fv(location, 1, glm::value_ptr(value));
+}
+
+
+auto MC_OpenGL::GLDevice::SetUniform(GLint location, const glm::mat4& value) -> void
+{
+	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+
+auto MC_OpenGL::GLDevice::UseProgram(GLuint program) -> void
+{
+	glUseProgram(program);
+}
+
+
+auto MC_OpenGL::GLDevice::VertexAttribute(GLuint index, GLint size, GLsizei stride, std::size_t offset, GLuint divisor) -> void
+{
+	glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+	glEnableVertexAttribArray(index);
+	if (divisor != 0)
+		glVertexAttribDivisor(index, divisor);
+}
+
+
+auto MC_OpenGL::GLDevice::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void
+{
+	glViewport(x, y, width, height);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+
+#include "RenderDevice.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Passes every call straight on to the current GL context. </summary>
+	class GLDevice : public RenderDevice
+	{
+	public:
+		auto ActiveTexture(GLuint unit) -> void override;
+		auto BindBuffer(GLenum target, GLuint buffer) -> void override;
+		auto BindBufferBase(GLenum target, GLuint index, GLuint buffer) -> void override;
+		auto BindSampler(GLuint unit, GLuint sampler) -> void override;
+		auto BindTexture(GLuint texture) -> void override;
+		auto BindVertexArray(GLuint vao) -> void override;
+		auto BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void override;
+		auto BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void override;
+		auto Clear(GLbitfield mask) -> void override;
+		auto ClearColor(float r, float g, float b, float a) -> void override;
+		auto CreateBuffer() -> GLuint override;
+		auto CreateVertexArray() -> GLuint override;
+		auto DeleteBuffer(GLuint buffer) -> void override;
+		auto DeleteTexture(GLuint texture) -> void override;
+		auto DeleteVertexArray(GLuint vao) -> void override;
+		auto Disable(GLenum capability) -> void override;
+		auto DrawArrays(GLenum mode, GLint first, GLsizei count) -> void override;
+		auto DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void override;
+		auto DrawElements(GLenum mode, GLsizei count, GLenum type, std::size_t offset) -> void override;
+		auto Enable(GLenum capability) -> void override;
+		auto SetUniform(GLint location, float value) -> void override;
+		auto SetUniform(GLint location, int value) -> void override;
+		auto SetUniform(GLint location, GLuint value) -> void override;
+		auto SetUniform(GLint location, const glm::vec3& value) -> void override;
+		auto SetUniform(GLint location, const glm::vec4& value) -> void override;
+		auto SetUniform(GLint location, const glm::mat4& value) -> void override;
+		auto UseProgram(GLuint program) -> void override;
+		auto VertexAttribute(GLuint index, GLint size, GLsizei stride, std::size_t offset, GLuint divisor = 0) -> void override;
+		auto Viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void override;
+	};
+
+
+}
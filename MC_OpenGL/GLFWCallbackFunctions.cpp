@@ -2,42 +2,39 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 #include <glm.hpp>
 
-#include <Mathematics/ContAlignedBox.h>
-#include <Mathematics/IntrLine3AlignedBox3.h>
-#include <Mathematics/IntrLine3Triangle3.h>
-#include <Mathematics/Line.h>
-#include <Mathematics/Vector3.h>
-
+#include "GLState.h"
 #include "GlobalState.h"
+#include "Profiler.h"
 #include "ProjectionOrthographic.h"
 
 
 namespace {
 
 
-// Forward Declarations
-auto ToGteVector3 (const glm::vec3 &glmVector) -> gte::Vector3<float>;
-
-
 auto ArcballRotate(GLFWwindow* window, float dx, float dy) -> void
 {
+	MC_PROFILE_ZONE("ArcballRotate");
 	MC_OpenGL::GlobalState* pGS = reinterpret_cast<MC_OpenGL::GlobalState*>(glfwGetWindowUserPointer(window));
 
 	float angleX = dx * 2.f * glm::pi<float>() / pGS->windowWidth;
 	float angleY = dy * 2.f * glm::pi<float>() / pGS->windowHeight;
 
 	pGS->camera.DoArcballRotation(angleX, angleY);
-	pGS->projection.ZoomFit(pGS->camera, pGS->drawables, pGS->camera.ViewMatrix(), true);
+	pGS->projection.ZoomFit(pGS->camera, pGS->sceneIndex, pGS->camera.ViewMatrix(), true);
 }
 
 
 auto CursorZoom (GLFWwindow *window, double offset) -> void
 	{
+	MC_PROFILE_ZONE ("CursorZoom");
 	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
-	pGS->projection.ZoomInOutToCursor ((float)offset);
+	pGS->unprojector.Update (pGS->camera, pGS->projection, pGS->windowWidth, pGS->windowHeight);
+	pGS->projection.ZoomInOutToCursor ((float)offset, pGS->unprojector.ViewPoint (pGS->cursorPosX, pGS->cursorPosY));
 	}
 
 
@@ -61,86 +58,37 @@ auto CycleGLPolygonMode (GLFWwindow *window) -> void
 
 auto Hover (GLFWwindow *window, double xPos, double yPos) -> void
 	{
-	int wx, wy;
-	glfwGetWindowSize (window, &wx, &wy);
-
+	MC_PROFILE_ZONE ("Hover");
 	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
-	const MC_OpenGL::ProjectionOrthographic &projection = pGS->projection;
+	pGS->unprojector.Update (pGS->camera, pGS->projection, pGS->windowWidth, pGS->windowHeight);
 
-	glm::vec3 ndc = glm::vec3 (xPos / wx, 1.f - yPos / wy, pGS->projection.GetNear()) * 2.f - 1.f;
-	auto viewSpace = glm::inverse (pGS->projection.ProjectionMatrix ()) * glm::vec4 (ndc, 1.f);
-	auto worldSpaceNear = glm::inverse (pGS->camera.ViewMatrix ()) * glm::vec4 (viewSpace);
+	const MC_OpenGL::WorldRay ray = pGS->unprojector.Ray (xPos, yPos);
+	const glm::vec3 &origin = ray.origin;
+	const glm::vec3 &direction = ray.direction;
 
-	ndc = glm::vec3 (xPos / wx, 1.f - yPos / wy, pGS->projection.GetFar()) * 2.f - 1.f;
-	viewSpace = glm::inverse (pGS->projection.ProjectionMatrix ()) * glm::vec4 (ndc, 1.f);
-	auto worldSpaceFar = glm::inverse (pGS->camera.ViewMatrix ()) * glm::vec4 (viewSpace);
-
-	int minIndex = (int)pGS->drawables.size ();
-	double minParm = std::numeric_limits<double>::max ();
-	for (int i = 0; i < pGS->drawables.size (); ++i)
+	// Boxes are hit where the ray enters them; STL meshes are hit on their triangles.
+	MC_OpenGL::SceneHit sceneHit = pGS->sceneIndex.Raycast (origin, direction, [&](MC_OpenGL::Drawable *drawable, float boxParameter)
 		{
-		pGS->drawables[i]->SetHover (false);
-
-		float x0 = std::numeric_limits<float>::max ();
-		float y0 = std::numeric_limits<float>::max ();
-		float z0 = std::numeric_limits<float>::max ();
-		float x1 = std::numeric_limits<float>::lowest ();
-		float y1 = std::numeric_limits<float>::lowest ();
-		float z1 = std::numeric_limits<float>::lowest ();
-		const auto &drawable = pGS->drawables[i];
-		const auto &boundingBox = drawable->BoundingBox ();
-		for (int j = 0; j < boundingBox.size (); ++j)
-			{
-			glm::vec3 ptWorldSpace = drawable->ModelMatrix () * glm::vec4 (boundingBox[j], 1.f);
-			x0 = std::min (x0, ptWorldSpace.x);
-			y0 = std::min (y0, ptWorldSpace.y);
-			x1 = std::max (x1, ptWorldSpace.x);
-			y1 = std::max (y1, ptWorldSpace.y);
-			z0 = std::min (z0, ptWorldSpace.z);
-			z1 = std::max (z1, ptWorldSpace.z);
-			}
+		if (drawable->GetType () != MC_OpenGL::DrawableType::Triangles)
+			return boxParameter;
 
-		gte::Vector3<float> bboxMin ({ x0, y0, z0 });
-		gte::Vector3<float> bboxMax ({ x1, y1, z1 });
+		MC_OpenGL::Triangles *stl = static_cast<MC_OpenGL::Triangles *>(drawable);
+		MC_OpenGL::BvhHit hit = stl->Intersect (origin, direction);
+		return hit.hit ? hit.parameter : std::numeric_limits<float>::infinity ();
+		});
 
-		gte::Line3<float> line (ToGteVector3 (worldSpaceNear), ToGteVector3 (glm::normalize (worldSpaceFar - worldSpaceNear)));
-		gte::AlignedBox3<float> box (bboxMin, bboxMax);
+	if (pGS->hovered != nullptr)
+		pGS->hovered->SetHover (false);
 
-		gte::FIQuery<float, gte::Line3<float>, gte::AlignedBox3<float> > fiq;
-		auto fiqResult = fiq (line, box);
-		if (fiqResult.intersect)
-			{
-			if (pGS->drawables[i]->GetType () == MC_OpenGL::DrawableType::Triangles)
-				{
-				MC_OpenGL::Triangles *stl = (MC_OpenGL::Triangles *)(pGS->drawables[i]);
-				const std::vector<gte::Triangle3<float> > triangles = stl->GetTriangles ();
-				for (int j = 0; j < triangles.size (); ++j)
-					{
-					gte::FIQuery<float, gte::Line3<float>, gte::Triangle3<float> > fiqTriangle;
-					gte::FIQuery<float, gte::Line3<float>, gte::Triangle3<float> >::Result fiqTriangleResult = fiqTriangle (line, triangles[j]);
-					if ((fiqTriangleResult.intersect)/* && (fiqTriangleResult.parameter < minParm)*/)
-						{
-						minParm = fiqResult.parameter[0];
-						minIndex = i;
-						}
-					}
-				}
-			else if (fiqResult.parameter[0] < minParm)
-				{
-				minParm = fiqResult.parameter[0];
-				minIndex = i;
-				}
-
-			}
-		}
-
-	if (minIndex < pGS->drawables.size ())
-		pGS->drawables[minIndex]->SetHover (true);
+	pGS->hovered = sceneHit.drawable;
+	if (pGS->hovered != nullptr)
+		pGS->hovered->SetHover (true);
 	}
 
 
 auto Pan(GLFWwindow* window, float dx, float dy) -> void
 {
+	MC_PROFILE_ZONE("Pan");
 	MC_OpenGL::GlobalState* pGS = reinterpret_cast<MC_OpenGL::GlobalState*>(glfwGetWindowUserPointer(window));
 	pGS->projection.Pan(dx, dy);
 }
@@ -149,17 +97,8 @@ auto Pan(GLFWwindow* window, float dx, float dy) -> void
 auto Select (GLFWwindow *window) -> void
 	{
 	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
-	for (int i = 0; i < pGS->drawables.size (); ++i)
-		{
-		if (pGS->drawables[i]->GetHover ())
-			pGS->drawables[i]->SetSelected (true);
-		}
-	}
-
-
-auto ToGteVector3 (const glm::vec3 &glmVector) -> gte::Vector3<float>
-	{
-	return gte::Vector3<float> ({ glmVector.x, glmVector.y, glmVector.z });
+	if (pGS->hovered != nullptr)
+		pGS->hovered->SetSelected (true);
 	}
 
 
@@ -175,6 +114,23 @@ auto UpdateCursorPosInfo(GLFWwindow* window, double xNew, double yNew) -> void
 }
 
 
+auto MoveCursor (GLFWwindow *window, const MC_OpenGL::InputEvent &event) -> void
+	{
+	UpdateCursorPosInfo (window, event.x, event.y);
+
+	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
+	float cursorDx = static_cast<float>(pGS->cursorPosX - pGS->cursorPosXPrev);
+	float cursorDy = static_cast<float>(pGS->cursorPosY - pGS->cursorPosYPrev);
+
+	if ((event.buttonsDown & (1 << GLFW_MOUSE_BUTTON_LEFT)) != 0)
+		Pan (window, cursorDx, cursorDy);
+	else if ((event.buttonsDown & (1 << GLFW_MOUSE_BUTTON_MIDDLE)) != 0)
+		ArcballRotate (window, cursorDx, cursorDy);
+	else if (pGS->pickMode == MC_OpenGL::PickMode::Ray)
+		Hover (window, event.x, event.y);
+	}
+
+
 auto WindowIsMinimized (int width, int height) -> bool
 	{
 	return ((width == 0) && (height == 0));
@@ -193,6 +149,7 @@ auto MC_OpenGL::GLFWCallbackFramebufferSize (GLFWwindow *window, int width, int
 
 	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
 	pGS->projection.Resize (pGS->windowWidth, pGS->windowHeight, (float)width, (float)height);
+	pGS->idPicker.Resize (width, height);
 
 	pGS->windowWidth = (float)width;
 	pGS->windowHeight = (float)height;
@@ -205,8 +162,8 @@ auto MC_OpenGL::GlfwCallbackKey (GLFWwindow *window, int key, int scancode, int
 
 	auto FitZAndCenter = [&pGS]()
 		{
-		pGS->projection.ZoomFit (pGS->camera, pGS->drawables, pGS->camera.ViewMatrix (), true);
-		pGS->projection.AutoCenter (pGS->camera, pGS->drawables, pGS->camera.ViewMatrix ());
+		pGS->projection.ZoomFit (pGS->camera, pGS->sceneIndex, pGS->camera.ViewMatrix (), true);
+		pGS->projection.AutoCenter (pGS->camera, pGS->sceneIndex, pGS->camera.ViewMatrix ());
 		};
 
 	if (((mods & GLFW_MOD_ALT) != 0) && ((mods & GLFW_MOD_SHIFT) != 0))
@@ -263,6 +220,34 @@ auto MC_OpenGL::GlfwCallbackKey (GLFWwindow *window, int key, int scancode, int
 			{
 			CycleGLPolygonMode (window);
 			}
+		if ((key == GLFW_KEY_F3) && (action == GLFW_PRESS))
+			{
+			// Switch between CPU ray casting and reading back the GPU ID buffer for hover.
+			if (pGS->pickMode == MC_OpenGL::PickMode::Ray)
+				pGS->pickMode = MC_OpenGL::PickMode::GpuId;
+			else
+				pGS->pickMode = MC_OpenGL::PickMode::Ray;
+
+			std::cout << "Pick mode: " << (pGS->pickMode == MC_OpenGL::PickMode::Ray ? "ray" : "GPU ID") << '\n';
+			}
+		if ((key == GLFW_KEY_F4) && (action == GLFW_PRESS))
+			{
+			pGS->geometry.Report (std::cout);
+			pGS->textures.Report (std::cout);
+			pGS->programs.Report (std::cout);
+			MC_OpenGL::GLState ().Report (std::cout);
+			pGS->culler.Report (std::cout);
+			pGS->input.Report (std::cout);
+			}
+#ifdef MC_OPENGL_PROFILE
+		if ((key == GLFW_KEY_F12) && (action == GLFW_PRESS))
+			{
+			if (MC_OpenGL::WriteProfileTrace (MC_OpenGL::ProfileTraceFilename))
+				std::cout << "Profile trace written to " << MC_OpenGL::ProfileTraceFilename << '\n';
+			else
+				std::cerr << "Error: cannot write " << MC_OpenGL::ProfileTraceFilename << '\n';
+			}
+#endif
 		if ((key == GLFW_KEY_UP) && (action == GLFW_PRESS || action == GLFW_REPEAT))
 			{
 			pGS->mixPercentage += 0.02f;
@@ -304,7 +289,7 @@ auto MC_OpenGL::GlfwCallbackKey (GLFWwindow *window, int key, int scancode, int
 			}
 		if ((key == GLFW_KEY_F) && (action == GLFW_PRESS))
 			{
-			pGS->projection.ZoomFit (pGS->camera, pGS->drawables, pGS->camera.ViewMatrix ());
+			pGS->projection.ZoomFit (pGS->camera, pGS->sceneIndex, pGS->camera.ViewMatrix ());
 			}
 		}
 	}
@@ -314,41 +299,86 @@ auto MC_OpenGL::GlfwCallbackCursorEnter (GLFWwindow *window, int entered) -> voi
 	{
 	MC_OpenGL::GlobalState *globalState = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
 
-	double xPos;
-	double yPos;
-	glfwGetCursorPos (window, &xPos, &yPos);
-
-	globalState->cursorPosXPrev = xPos;
-	globalState->cursorPosYPrev = yPos;
+	MC_OpenGL::InputEvent event;
+	event.type = MC_OpenGL::InputEventType::CursorEnter;
+	event.time = glfwGetTime ();
+	glfwGetCursorPos (window, &event.x, &event.y);
+	globalState->input.Push (event);
 	}
 
 
 auto MC_OpenGL::GlfwCallbackCursorPos (GLFWwindow *window, double xpos, double ypos) -> void
 	{
-	UpdateCursorPosInfo(window, xpos, ypos);
-
 	MC_OpenGL::GlobalState* pGS = reinterpret_cast<MC_OpenGL::GlobalState*>(glfwGetWindowUserPointer(window));
-	float cursorDx = static_cast<float>(pGS->cursorPosX - pGS->cursorPosXPrev);
-	float cursorDy = static_cast<float>(pGS->cursorPosY - pGS->cursorPosYPrev);
 
+	// The buttons are read now, since by the time the move is handled they may have changed.
+	MC_OpenGL::InputEvent event;
+	event.type = MC_OpenGL::InputEventType::CursorMove;
+	event.time = glfwGetTime();
+	event.x = xpos;
+	event.y = ypos;
 	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT))
-		Pan(window, cursorDx, cursorDy);
-	else if (glfwGetMouseButton (window, GLFW_MOUSE_BUTTON_MIDDLE))
-		ArcballRotate(window, cursorDx, cursorDy);
-	else
-		Hover (window, xpos, ypos);
+		event.buttonsDown |= 1 << GLFW_MOUSE_BUTTON_LEFT;
+	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE))
+		event.buttonsDown |= 1 << GLFW_MOUSE_BUTTON_MIDDLE;
+	pGS->input.Push(event);
 	}
 
 
 auto MC_OpenGL::GlfwCallbackMouseButton (GLFWwindow *window, int button, int action, int mods) -> void
 	{
 	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
-	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
-		Select (window);
+
+	MC_OpenGL::InputEvent event;
+	event.type = MC_OpenGL::InputEventType::MouseButton;
+	event.time = glfwGetTime ();
+	event.button = button;
+	event.action = action;
+	event.mods = mods;
+	pGS->input.Push (event);
 	}
 
 
 auto MC_OpenGL::GlfwCallbackScroll (GLFWwindow *window, double xoffset, double yoffset) -> void
 	{
-	CursorZoom (window, yoffset);
+	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
+
+	MC_OpenGL::InputEvent event;
+	event.type = MC_OpenGL::InputEventType::Scroll;
+	event.time = glfwGetTime ();
+	event.x = xoffset;
+	event.y = yoffset;
+	pGS->input.Push (event);
+	}
+
+
+auto MC_OpenGL::ProcessInput (GLFWwindow *window) -> void
+	{
+	MC_PROFILE_ZONE ("ProcessInput");
+	MC_OpenGL::GlobalState *pGS = reinterpret_cast<MC_OpenGL::GlobalState *>(glfwGetWindowUserPointer (window));
+
+	// Kept from frame to frame, so that draining does not allocate.
+	static std::vector<MC_OpenGL::InputEvent> events;
+	pGS->input.Drain (events);
+
+	for (const MC_OpenGL::InputEvent &event : events)
+		{
+		switch (event.type)
+			{
+			case MC_OpenGL::InputEventType::CursorEnter:
+				pGS->cursorPosXPrev = event.x;
+				pGS->cursorPosYPrev = event.y;
+				break;
+			case MC_OpenGL::InputEventType::CursorMove:
+				MoveCursor (window, event);
+				break;
+			case MC_OpenGL::InputEventType::MouseButton:
+				if (event.button == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_PRESS)
+					Select (window);
+				break;
+			case MC_OpenGL::InputEventType::Scroll:
+				CursorZoom (window, event.y);
+				break;
+			}
+		}
 	}
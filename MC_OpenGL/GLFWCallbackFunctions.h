@@ -15,5 +15,9 @@ auto GlfwCallbackCursorPos (GLFWwindow *window, double xpos, double ypos) -> voi
 auto GlfwCallbackMouseButton (GLFWwindow* window, int button, int action, int mods) -> void;
 auto GlfwCallbackScroll(GLFWwindow* window, double xoffset, double yoffset) -> void;
 
+/// <summary> Handle the mouse input the callbacks above queued since the last call. Call once per frame,
+/// 		  after polling events. </summary>
+auto ProcessInput (GLFWwindow *window) -> void;
+
 
 }
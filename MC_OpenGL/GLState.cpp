@@ -0,0 +1,144 @@
+#include "GLState.h"
+
+#include "RenderDevice.h"
+
+
+auto MC_OpenGL::GLState() -> StateCache&
+{
+	static StateCache state;
+	return state;
+}
+
+
+auto MC_OpenGL::StateCache::ActiveTexture(GLuint unit) -> void
+{
+	if (unit == m_ActiveUnit)
+	{
+		++m_Frame.elided;
+		return;
+	}
+
+	Device().ActiveTexture(unit);
+	m_ActiveUnit = unit;
+	++m_Frame.issued;
+}
+
+
+auto MC_OpenGL::StateCache::BindForEdit(GLuint unit, GLuint texture) -> void
+{
+	ActiveTexture(unit);
+	BindTexture(unit, texture);
+}
+
+
+auto MC_OpenGL::StateCache::BindSampler(GLuint unit, GLuint sampler) -> void
+{
+	if (unit < maxTextureUnits && m_Samplers[unit] == sampler)
+	{
+		++m_Frame.elided;
+		return;
+	}
+
+	Device().BindSampler(unit, sampler);
+	if (unit < maxTextureUnits)
+		m_Samplers[unit] = sampler;
+	++m_Frame.issued;
+}
+
+
+auto MC_OpenGL::StateCache::BindTexture(GLuint unit, GLuint texture) -> void
+{
+	if (unit < maxTextureUnits && m_Textures[unit] == texture)
+	{
+		++m_Frame.elided;
+		return;
+	}
+
+	ActiveTexture(unit);
+	Device().BindTexture(texture);
+	if (unit < maxTextureUnits)
+		m_Textures[unit] = texture;
+	++m_Frame.issued;
+}
+
+
+auto MC_OpenGL::StateCache::BindVertexArray(GLuint vao) -> void
+{
+	if (vao == m_Vao)
+	{
+		++m_Frame.elided;
+		return;
+	}
+
+	Device().BindVertexArray(vao);
+	m_Vao = vao;
+	++m_Frame.issued;
+}
+
+
+auto MC_OpenGL::StateCache::DeleteTexture(GLuint texture) -> void
+{
+	if (texture == 0)
+		return;
+
+	Device().DeleteTexture(texture);
+	for (GLuint& bound : m_Textures)
+	{
+		if (bound == texture)
+			bound = 0;
+	}
+}
+
+
+auto MC_OpenGL::StateCache::DeleteVertexArray(GLuint vao) -> void
+{
+	if (vao == 0)
+		return;
+
+	Device().DeleteVertexArray(vao);
+	if (m_Vao == vao)
+		m_Vao = 0;
+}
+
+
+auto MC_OpenGL::StateCache::EndFrame() -> void
+{
+	m_LastFrame = m_Frame;
+	m_Frame = GLStateStats();
+}
+
+
+auto MC_OpenGL::StateCache::Invalidate() -> void
+{
+	m_Program = unknown;
+	m_Vao = unknown;
+	m_ActiveUnit = unknown;
+	m_Textures = Unknowns();
+	m_Samplers = Unknowns();
+}
+
+
+auto MC_OpenGL::StateCache::Report(std::ostream& os) const -> void
+{
+	os << "GL state: " << m_LastFrame.issued << " binds issued, " << m_LastFrame.elided << " elided last frame\n";
+}
+
+
+auto MC_OpenGL::StateCache::Stats() const -> const GLStateStats&
+{
+	return m_LastFrame;
+}
+
+
+auto MC_OpenGL::StateCache::UseProgram(GLuint program) -> void
+{
+	if (program == m_Program)
+	{
+		++m_Frame.elided;
+		return;
+	}
+
+	Device().UseProgram(program);
+	m_Program = program;
+	++m_Frame.issued;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+
+#include <glad/glad.h>
+
+
+namespace MC_OpenGL
+{
+
+
+	struct GLStateStats
+	{
+		std::size_t		issued	= 0;	// Calls passed on to GL.
+		std::size_t		elided	= 0;	// Calls skipped because the state was already set.
+	};
+
+
+	/// <summary> Shadow copy of the bindings draws change most: the program, the vertex array, the active
+	/// 		  texture unit and the 2D texture and sampler of each unit. Calls that match the copy are not
+	/// 		  passed on to the render device. The copy is only right while every change to these bindings in the program
+	/// 		  goes through the instance returned by GLState(); code that cannot has to call Invalidate. </summary>
+	class StateCache
+	{
+	public:
+		static constexpr GLuint maxTextureUnits = 16;
+
+		StateCache() = default;
+		StateCache(const StateCache&) = delete;
+		auto operator=(const StateCache&) -> StateCache& = delete;
+
+		auto ActiveTexture(GLuint unit) -> void;
+
+		/// <summary> Bind texture to unit and make unit the active one even if texture was bound already, so
+		/// 		  that glTexImage2D and the like reach it. Use this before changing a texture. </summary>
+		auto BindForEdit(GLuint unit, GLuint texture) -> void;
+		auto BindSampler(GLuint unit, GLuint sampler) -> void;
+
+		/// <summary> Bind texture to GL_TEXTURE_2D of unit for drawing. Only a changed binding makes unit the
+		/// 		  active unit, so the active unit is unknown afterwards. </summary>
+		auto BindTexture(GLuint unit, GLuint texture) -> void;
+		auto BindVertexArray(GLuint vao) -> void;
+
+		/// <summary> Delete the objects and forget them. GL unbinds deleted objects, and their names may come
+		/// 		  back for new ones. </summary>
+		auto DeleteTexture(GLuint texture) -> void;
+		auto DeleteVertexArray(GLuint vao) -> void;
+
+		/// <summary> Start counting the next frame. Stats and Report describe the frame just ended. </summary>
+		auto EndFrame() -> void;
+
+		/// <summary> Forget all bindings, so that the next call of every kind is passed on. </summary>
+		auto Invalidate() -> void;
+		auto Report(std::ostream& os) const -> void;
+		auto Stats() const -> const GLStateStats&;
+		auto UseProgram(GLuint program) -> void;
+
+	private:
+		// No GL object is named unknown, so it never matches a requested binding.
+		static constexpr GLuint unknown = ~GLuint(0);
+
+		GLuint								m_Program		= unknown;
+		GLuint								m_Vao			= unknown;
+		GLuint								m_ActiveUnit	= unknown;
+		std::array<GLuint, maxTextureUnits>	m_Textures		= Unknowns();
+		std::array<GLuint, maxTextureUnits>	m_Samplers		= Unknowns();
+		GLStateStats						m_Frame;
+		GLStateStats						m_LastFrame;
+
+		static auto Unknowns() -> std::array<GLuint, maxTextureUnits>
+		{
+			std::array<GLuint, maxTextureUnits> units;
+			units.fill(unknown);
+			return units;
+		}
+	};
+
+
+	/// <summary> The state cache of the one GL context. </summary>
+	auto GLState() -> StateCache&;
+
+
+}
@@ -0,0 +1,184 @@
+#include "GeometryRegistry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+#include "GLState.h"
+#include "MappedFile.h"
+#include "MeshWeld.h"
+#include "RenderDevice.h"
+#include "StlReader.h"
+
+
+namespace {
+
+
+auto DeleteMesh(MC_OpenGL::Mesh* mesh) -> void
+{
+	MC_OpenGL::Device().DeleteBuffer(mesh->ebo);
+	MC_OpenGL::Device().DeleteBuffer(mesh->vbo);
+	MC_OpenGL::GLState().DeleteVertexArray(mesh->vao);
+	delete mesh;
+}
+
+
+}
+
+
+auto MC_OpenGL::GeometryRegistry::LoadStl(const std::string& filename) -> MeshHandle
+{
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::weakly_canonical(filename, error);
+	if (error)
+		path = filename;
+	const std::string key = path.string();
+	const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+
+	// An unchanged file that was loaded before needs neither reading nor hashing.
+	auto file = m_Files.find(key);
+	if (!error && file != m_Files.end() && file->second.time == time)
+	{
+		if (MeshHandle mesh = file->second.mesh.lock())
+		{
+			++m_Stats.pathHits;
+			m_Stats.bytesSaved += mesh->gpuBytes;
+			return mesh;
+		}
+	}
+
+	// The one mapping is both hashed and parsed.
+	MappedFile mapped(key);
+	if (!mapped)
+	{
+		std::cerr << "Error: failed to load STL file " << filename << '\n';
+		return Upload(std::vector<float>());
+	}
+	const ContentHash contentHash = HashBytes(mapped.Data(), mapped.Size());
+
+	auto cached = m_Meshes.find(contentHash);
+	if (cached != m_Meshes.end())
+	{
+		MeshHandle mesh = cached->second.mesh.lock();
+		if (mesh && SameContents(cached->second, mapped.Data(), mapped.Size()))
+		{
+			if (!error)
+				m_Files[key] = FileEntry{ time, mesh };
+			++m_Stats.contentHits;
+			m_Stats.bytesSaved += mesh->gpuBytes;
+			return mesh;
+		}
+	}
+
+	std::vector<float> vertices;
+	if (ReadStl(mapped.Data(), mapped.Size(), vertices) != ErrorCode::NONE)
+	{
+		std::cerr << "Error: failed to load STL file " << filename << '\n';
+		return Upload(std::vector<float>());
+	}
+
+	std::shared_ptr<Mesh> mesh = Upload(vertices);
+	if (!error)
+	{
+		m_Files[key] = FileEntry{ time, mesh };
+
+		// A live mesh under the same hash with other contents keeps its slot; this one is only found by path.
+		if (cached == m_Meshes.end() || cached->second.mesh.expired())
+			m_Meshes[contentHash] = MeshEntry{ mesh, key, time, mapped.Size() };
+	}
+	return mesh;
+}
+
+
+auto MC_OpenGL::GeometryRegistry::Report(std::ostream& os) const -> void
+{
+	std::size_t alive = 0;
+	std::size_t aliveBytes = 0;
+	for (const auto& [hash, entry] : m_Meshes)
+	{
+		if (MeshHandle mesh = entry.mesh.lock())
+		{
+			++alive;
+			aliveBytes += mesh->gpuBytes;
+		}
+	}
+
+	os << "Geometry: " << alive << " meshes alive (" << aliveBytes << " bytes), "
+		<< m_Stats.uploads << " uploads (" << m_Stats.bytesUploaded << " bytes), "
+		<< m_Stats.pathHits << " path hits, " << m_Stats.contentHits << " content hits, "
+		<< m_Stats.bytesSaved << " bytes saved by sharing\n";
+}
+
+
+auto MC_OpenGL::GeometryRegistry::SameContents(const MeshEntry& entry, const char* data, std::size_t size) const -> bool
+{
+	if (entry.size != size)
+		return false;
+
+	// Without an unchanged source there is nothing to compare against, so the hash alone is not trusted.
+	std::error_code error;
+	const std::filesystem::file_time_type time = std::filesystem::last_write_time(entry.source, error);
+	if (error || time != entry.time)
+		return false;
+
+	MappedFile source(entry.source);
+	return source && source.Size() == size && std::memcmp(source.Data(), data, size) == 0;
+}
+
+
+auto MC_OpenGL::GeometryRegistry::Stats() const -> const GeometryStats&
+{
+	return m_Stats;
+}
+
+
+auto MC_OpenGL::GeometryRegistry::Upload(const std::vector<float>& vertices) -> std::shared_ptr<Mesh>
+{
+	std::shared_ptr<Mesh> mesh(new Mesh(), DeleteMesh);
+	mesh->numVertices = static_cast<GLsizei>(vertices.size() / StlFloatsPerVertex);
+
+	// The interleaved vertices only live until they are uploaded; picking and bounds use the store.
+	mesh->triangles.Assign(vertices, StlFloatsPerVertex);
+	mesh->bvh.Build(mesh->triangles);
+	mesh->triangles.Bounds(mesh->boundsMin, mesh->boundsMax);
+
+	WeldedMesh welded;
+	WeldVertices(vertices, StlFloatsPerVertex, StlNormalOffset, 1e-6f * glm::length(mesh->boundsMax - mesh->boundsMin), 30.f, welded);
+
+	mesh->vao = Device().CreateVertexArray();
+	GLState().BindVertexArray(mesh->vao);
+
+	mesh->vbo = Device().CreateBuffer();
+	Device().BindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+	Device().BufferData(GL_ARRAY_BUFFER, welded.vertices.size() * sizeof(float), welded.vertices.data(), GL_STATIC_DRAW);
+	mesh->gpuBytes = welded.vertices.size() * sizeof(float);
+
+	Device().VertexAttribute(0, 3, 8 * sizeof(float), 0);
+	Device().VertexAttribute(1, 2, 8 * sizeof(float), 3 * sizeof(float));
+	Device().VertexAttribute(2, 3, 8 * sizeof(float), 5 * sizeof(float));
+
+	// 16 bit indices halve the index buffer whenever the welded part is small enough.
+	mesh->ebo = Device().CreateBuffer();
+	Device().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+	mesh->numIndices = static_cast<GLsizei>(welded.indices.size());
+	if (welded.vertices.size() / StlFloatsPerVertex <= 0x10000)
+	{
+		std::vector<std::uint16_t> indices16(welded.indices.size());
+		std::transform(welded.indices.begin(), welded.indices.end(), indices16.begin(), [](std::uint32_t index) { return static_cast<std::uint16_t>(index); });
+		Device().BufferData(GL_ELEMENT_ARRAY_BUFFER, indices16.size() * sizeof(std::uint16_t), indices16.data(), GL_STATIC_DRAW);
+		mesh->indexType = GL_UNSIGNED_SHORT;
+		mesh->gpuBytes += indices16.size() * sizeof(std::uint16_t);
+	}
+	else
+	{
+		Device().BufferData(GL_ELEMENT_ARRAY_BUFFER, welded.indices.size() * sizeof(std::uint32_t), welded.indices.data(), GL_STATIC_DRAW);
+		mesh->indexType = GL_UNSIGNED_INT;
+		mesh->gpuBytes += welded.indices.size() * sizeof(std::uint32_t);
+	}
+	GLState().BindVertexArray(0);
+
+	++m_Stats.uploads;
+	m_Stats.bytesUploaded += mesh->gpuBytes;
+	return mesh;
+}
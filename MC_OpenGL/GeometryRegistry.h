@@ -0,0 +1,101 @@
+#pragma once
+
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+#include "Bvh.h"
+#include "Hash.h"
+#include "TriangleStore.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> GPU buffers of one triangle mesh plus the CPU side data used for picking and bounds.
+	/// 		  Shared by every drawable showing the same geometry; the GL objects are deleted with the last
+	/// 		  reference, so that must happen while the context is current. </summary>
+	struct Mesh
+	{
+		GLuint			vao				= 0;
+		GLuint			vbo				= 0;
+		GLuint			ebo				= 0;
+		GLsizei			numVertices		= 0;	// Draw count when there is no index buffer.
+		GLsizei			numIndices		= 0;
+		GLenum			indexType		= GL_UNSIGNED_INT;
+		std::size_t		gpuBytes		= 0;
+		glm::vec3		boundsMin		= glm::vec3(0.f);
+		glm::vec3		boundsMax		= glm::vec3(0.f);
+		TriangleStore	triangles;
+		Bvh				bvh;
+	};
+
+	using MeshHandle = std::shared_ptr<const Mesh>;
+
+
+	struct GeometryStats
+	{
+		std::size_t		uploads			= 0;	// Meshes built and sent to the GPU.
+		std::size_t		pathHits		= 0;	// Requests for an unchanged file that was already loaded.
+		std::size_t		contentHits		= 0;	// Requests for a different file with identical contents.
+		std::size_t		bytesUploaded	= 0;
+		std::size_t		bytesSaved		= 0;	// GPU bytes that duplicates would have taken.
+	};
+
+
+	/// <summary> Hands out shared meshes so that identical geometry is uploaded once, however many drawables
+	/// 		  use it. Files are keyed by path and modification time, then by a hash of their contents, so
+	/// 		  an edited file is reloaded and a copy under another name is not. A hash match is only taken
+	/// 		  after comparing the bytes with the file the mesh came from. The registry only keeps weak
+	/// 		  references; a mesh lives as long as some drawable holds its handle. </summary>
+	class GeometryRegistry
+	{
+	public:
+		GeometryRegistry() = default;
+		GeometryRegistry(const GeometryRegistry&) = delete;
+		auto operator=(const GeometryRegistry&) -> GeometryRegistry& = delete;
+
+		/// <summary> Mesh of an ASCII or binary STL file. A file that cannot be read gives an empty mesh,
+		/// 		  which is not cached. </summary>
+		auto LoadStl(const std::string& filename) -> MeshHandle;
+
+		/// <summary> Print the statistics and the meshes still alive. </summary>
+		auto Report(std::ostream& os) const -> void;
+		auto Stats() const -> const GeometryStats&;
+
+	private:
+		struct FileEntry
+		{
+			std::filesystem::file_time_type	time;
+			std::weak_ptr<const Mesh>		mesh;
+		};
+
+		/// <summary> A mesh by content, with the file it was read from so a hash match can be checked. </summary>
+		struct MeshEntry
+		{
+			std::weak_ptr<const Mesh>		mesh;
+			std::string						source;
+			std::filesystem::file_time_type	time;
+			std::size_t						size	= 0;
+		};
+
+		auto SameContents(const MeshEntry& entry, const char* data, std::size_t size) const -> bool;
+		auto Upload(const std::vector<float>& vertices) -> std::shared_ptr<Mesh>;
+
+		std::unordered_map<std::string, FileEntry>							m_Files;
+		std::unordered_map<ContentHash, MeshEntry, ContentHashHasher>		m_Meshes;
+		GeometryStats														m_Stats;
+	};
+
+
+}
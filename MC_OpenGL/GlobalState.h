@@ -7,7 +7,16 @@
 
 #include "Camera.h"
 #include "Drawable.h"
+#include "GeometryRegistry.h"
+#include "IdPicker.h"
+#include "InputQueue.h"
+#include "ProgramCache.h"
 #include "ProjectionOrthographic.h"
+#include "SceneIndex.h"
+#include "ShaderCompiler.h"
+#include "TextureManager.h"
+#include "Unprojector.h"
+#include "ViewCuller.h"
 
 
 namespace MC_OpenGL {
@@ -18,6 +27,17 @@ struct GlobalState
 	Camera								camera			= Camera();
 	ProjectionOrthographic				projection		= ProjectionOrthographic();
 	std::vector<MC_OpenGL::Drawable *>	drawables		= std::vector<MC_OpenGL::Drawable*>();
+	GeometryRegistry					geometry		= GeometryRegistry();
+	SceneIndex							sceneIndex		= SceneIndex();
+	ViewCuller							culler			= ViewCuller();
+	Unprojector							unprojector		= Unprojector();
+	TextureManager						textures		= TextureManager();
+	MC_OpenGL::Drawable *				hovered			= nullptr;
+	InputQueue							input			= InputQueue();
+	PickMode							pickMode		= PickMode::Ray;
+	IdPicker							idPicker		= IdPicker();
+	ProgramCache						programs		= ProgramCache();
+	ShaderCompiler						shaders			= ShaderCompiler(programs);
 	double								cursorPosX		= 0.;
 	double								cursorPosY		= 0.;
 	double								cursorPosXPrev	= 0.;
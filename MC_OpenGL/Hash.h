@@ -0,0 +1,139 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> 128 bit hash of some contents. Wide enough that the on-disk caches can treat equal hashes
+	/// 		  as equal contents; anything that can compare the bytes as well should. </summary>
+	struct ContentHash
+	{
+		std::uint64_t	low		= 0;
+		std::uint64_t	high	= 0;
+
+		auto operator==(const ContentHash& other) const -> bool
+		{
+			return low == other.low && high == other.high;
+		}
+
+		auto operator!=(const ContentHash& other) const -> bool
+		{
+			return !(*this == other);
+		}
+	};
+
+
+	struct ContentHashHasher
+	{
+		auto operator()(const ContentHash& hash) const -> std::size_t
+		{
+			return static_cast<std::size_t>(hash.low);
+		}
+	};
+
+
+	/// <summary> MurmurHash3 x64 128. Not meant to resist attacks, but every input bit reaches every output
+	/// 		  bit, which FNV over whole words did not do. </summary>
+	inline auto HashBytes(const char* data, std::size_t size) -> ContentHash
+	{
+		constexpr std::uint64_t c1 = 0x87c37b91114253d5ull;
+		constexpr std::uint64_t c2 = 0x4cf5ad432745937full;
+
+		auto Rotate = [](std::uint64_t x, int r) -> std::uint64_t { return (x << r) | (x >> (64 - r)); };
+		auto Finalize = [](std::uint64_t k) -> std::uint64_t
+		{
+			k ^= k >> 33;
+			k *= 0xff51afd7ed558ccdull;
+			k ^= k >> 33;
+			k *= 0xc4ceb9fe1a85ec53ull;
+			k ^= k >> 33;
+			return k;
+		};
+
+		std::uint64_t h1 = 0;
+		std::uint64_t h2 = 0;
+
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			std::uint64_t k1;
+			std::uint64_t k2;
+			std::memcpy(&k1, data + i, sizeof(k1));
+			std::memcpy(&k2, data + i + 8, sizeof(k2));
+
+			k1 *= c1;
+			k1 = Rotate(k1, 31);
+			k1 *= c2;
+			h1 ^= k1;
+			h1 = Rotate(h1, 27);
+			h1 += h2;
+			h1 = h1 * 5 + 0x52dce729;
+
+			k2 *= c2;
+			k2 = Rotate(k2, 33);
+			k2 *= c1;
+			h2 ^= k2;
+			h2 = Rotate(h2, 31);
+			h2 += h1;
+			h2 = h2 * 5 + 0x38495ab5;
+		}
+
+		std::uint64_t k1 = 0;
+		std::uint64_t k2 = 0;
+		for (std::size_t tail = 0; i + tail < size; ++tail)
+		{
+			const std::uint64_t byte = static_cast<unsigned char>(data[i + tail]);
+			if (tail < 8)
+				k1 |= byte << (8 * tail);
+			else
+				k2 |= byte << (8 * (tail - 8));
+		}
+		if (size - i > 8)
+		{
+			k2 *= c2;
+			k2 = Rotate(k2, 33);
+			k2 *= c1;
+			h2 ^= k2;
+		}
+		if (size - i > 0)
+		{
+			k1 *= c1;
+			k1 = Rotate(k1, 31);
+			k1 *= c2;
+			h1 ^= k1;
+		}
+
+		h1 ^= size;
+		h2 ^= size;
+		h1 += h2;
+		h2 += h1;
+		h1 = Finalize(h1);
+		h2 = Finalize(h2);
+		h1 += h2;
+		h2 += h1;
+		return ContentHash{ h1, h2 };
+	}
+
+
+	/// <summary> 32 lower case hex digits, for naming cache files. </summary>
+	inline auto HashToHex(const ContentHash& hash) -> std::string
+	{
+		constexpr char digits[] = "0123456789abcdef";
+		std::string hex(32, '0');
+		for (int i = 0; i < 16; ++i)
+		{
+			hex[15 - i] = digits[(hash.high >> (4 * i)) & 0xF];
+			hex[31 - i] = digits[(hash.low >> (4 * i)) & 0xF];
+		}
+		return hex;
+	}
+
+
+}
@@ -0,0 +1,178 @@
+#include "IdPicker.h"
+
+#include <iostream>
+
+#include "GLState.h"
+
+
+auto MC_OpenGL::IdPicker::CreateTargets() -> ErrorCode
+{
+	glGenTextures(1, &m_IdTexture);
+	GLState().BindForEdit(0, m_IdTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, m_Width, m_Height, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+	GLState().BindTexture(0, 0);
+
+	glGenRenderbuffers(1, &m_DepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_Width, m_Height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_Fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_Fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_IdTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "Error: pick framebuffer is incomplete (0x" << std::hex << status << std::dec << ")\n";
+		DeleteTargets();
+		return ErrorCode::ERROR_PICK_FRAMEBUFFER_INCOMPLETE;
+	}
+
+	return ErrorCode::NONE;
+}
+
+
+auto MC_OpenGL::IdPicker::DeleteTargets() -> void
+{
+	glDeleteFramebuffers(1, &m_Fbo);
+	glDeleteRenderbuffers(1, &m_DepthBuffer);
+	GLState().DeleteTexture(m_IdTexture);
+	m_Fbo = 0;
+	m_DepthBuffer = 0;
+	m_IdTexture = 0;
+}
+
+
+auto MC_OpenGL::IdPicker::Initialize(ShaderCompiler& shaders, int width, int height) -> ErrorCode
+{
+	m_Shader = shaders.Submit(R"(..\shaders\vsPickId.glsl)", R"(..\shaders\fsPickId.glsl)");
+
+	// Each slot holds one RG32UI pixel.
+	for (Slot& slot : m_Slots)
+	{
+		glGenBuffers(1, &slot.pbo);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 2 * sizeof(GLuint), nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_Width = width;
+	m_Height = height;
+	return CreateTargets();
+}
+
+
+auto MC_OpenGL::IdPicker::Poll(PickResult& result) -> bool
+{
+	bool found = false;
+	while (m_InFlight > 0)
+	{
+		Slot& slot = m_Slots[(m_NextSlot - m_InFlight + numSlots) % numSlots];
+		GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+			break;
+
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		--m_InFlight;
+		if (status == GL_WAIT_FAILED)
+			continue;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		const GLuint* ids = static_cast<const GLuint*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 2 * sizeof(GLuint), GL_MAP_READ_BIT));
+		if (ids != nullptr)
+		{
+			result.objectId = ids[0];
+			result.primitiveId = ids[1];
+			result.x = slot.x;
+			result.y = slot.y;
+			found = true;
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	return found;
+}
+
+
+auto MC_OpenGL::IdPicker::Release() -> void
+{
+	for (Slot& slot : m_Slots)
+	{
+		if (slot.fence != nullptr)
+			glDeleteSync(slot.fence);
+		glDeleteBuffers(1, &slot.pbo);
+		slot = Slot();
+	}
+	m_InFlight = 0;
+
+	DeleteTargets();
+}
+
+
+auto MC_OpenGL::IdPicker::Render(const std::vector<Drawable*>& drawables, int x, int y) -> void
+{
+	if (m_Fbo == 0 || m_InFlight == numSlots || !m_Shader)
+		return;
+	if (x < 0 || y < 0 || x >= m_Width || y >= m_Height)
+		return;
+
+	// Only the pixel under the cursor is ever read, so the scissor keeps the fragment cost at one pixel.
+	const int glY = m_Height - 1 - y;
+	glBindFramebuffer(GL_FRAMEBUFFER, m_Fbo);
+	glViewport(0, 0, m_Width, m_Height);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(x, glY, 1, 1);
+
+	const GLuint background[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, background);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	m_Shader.Use();
+	if (!m_UniformsResolved)
+	{
+		m_ModelUniform = m_Shader.GetUniform<glm::mat4>("model");
+		m_ObjectIdUniform = m_Shader.GetUniform<GLuint>("objectId");
+		m_UniformsResolved = true;
+	}
+	for (std::size_t i = 0; i < drawables.size(); ++i)
+	{
+		m_ModelUniform.Set(drawables[i]->ModelMatrix());
+		m_ObjectIdUniform.Set(static_cast<GLuint>(i + 1));
+		drawables[i]->DrawMesh();
+	}
+
+	Slot& slot = m_Slots[m_NextSlot];
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(x, glY, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.x = x;
+	slot.y = y;
+
+	m_NextSlot = (m_NextSlot + 1) % numSlots;
+	++m_InFlight;
+
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+
+auto MC_OpenGL::IdPicker::Resize(int width, int height) -> void
+{
+	if (m_Fbo == 0 || (width == m_Width && height == m_Height))
+		return;
+
+	// Readbacks already queued stay valid; they live in the pixel buffers, not in the targets.
+	DeleteTargets();
+	m_Width = width;
+	m_Height = height;
+	CreateTargets();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+#include "Drawable.h"
+#include "ErrorCode.h"
+#include "Shader.h"
+#include "ShaderCompiler.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	enum class PickMode
+	{
+		Ray,
+		GpuId
+	};
+
+
+	struct PickResult
+	{
+		std::uint32_t	objectId	= 0;	// Index into the drawables passed to Render plus one; 0 for the background.
+		std::uint32_t	primitiveId	= 0;	// Triangle within the drawable's draw call.
+		int				x			= 0;
+		int				y			= 0;
+	};
+
+
+	/// <summary> Picks by rendering drawable IDs into an offscreen integer target. The pixel under the cursor
+	/// 		  is read back through a ring of pixel buffer objects guarded by fences, so results arrive a frame
+	/// 		  or two late but the CPU never waits on the GPU. Needs only a current GL 3.3 context. </summary>
+	class IdPicker
+	{
+	public:
+		IdPicker() = default;
+		IdPicker(const IdPicker&) = delete;
+		auto operator=(const IdPicker&) -> IdPicker& = delete;
+
+		auto Initialize(ShaderCompiler& shaders, int width, int height) -> ErrorCode;
+
+		/// <summary> Delete the GL objects. Call while the context is still current. </summary>
+		auto Release() -> void;
+
+		/// <summary> Newest completed readback, if one finished since the last call. Never blocks. </summary>
+		auto Poll(PickResult& result) -> bool;
+
+		/// <summary> Render the pixel at (x, y), in window coordinates with y down, and queue its readback.
+		/// 		  Skipped while every readback slot is still in flight or the program is not ready. </summary>
+		auto Render(const std::vector<Drawable*>& drawables, int x, int y) -> void;
+		auto Resize(int width, int height) -> void;
+
+	private:
+		static constexpr int numSlots = 3;
+
+		struct Slot
+		{
+			GLuint	pbo		= 0;
+			GLsync	fence	= nullptr;
+			int		x		= 0;
+			int		y		= 0;
+		};
+
+		auto CreateTargets() -> ErrorCode;
+		auto DeleteTargets() -> void;
+
+		Shader						m_Shader;
+		Uniform<glm::mat4>			m_ModelUniform;
+		Uniform<GLuint>				m_ObjectIdUniform;
+		bool						m_UniformsResolved		= false;
+		GLuint						m_Fbo					= 0;
+		GLuint						m_IdTexture				= 0;
+		GLuint						m_DepthBuffer			= 0;
+		int							m_Width					= 0;
+		int							m_Height				= 0;
+		std::array<Slot, numSlots>	m_Slots;
+		int							m_NextSlot				= 0;	// Slot the next Render writes to.
+		int							m_InFlight				= 0;	// Pending slots, ending just before m_NextSlot.
+	};
+
+
+}
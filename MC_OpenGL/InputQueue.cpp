@@ -0,0 +1,49 @@
+#include "InputQueue.h"
+
+
+auto MC_OpenGL::InputQueue::Drain(std::vector<InputEvent>& events) -> void
+{
+	m_Stats.dispatched += m_Events.size();
+	events.swap(m_Events);
+	m_Events.clear();
+}
+
+
+auto MC_OpenGL::InputQueue::Push(const InputEvent& event) -> void
+{
+	++m_Stats.received;
+
+	if (!m_Events.empty() && m_Events.back().type == event.type)
+	{
+		InputEvent& last = m_Events.back();
+		if (event.type == InputEventType::CursorMove && event.buttonsDown == last.buttonsDown)
+		{
+			last.time = event.time;
+			last.x = event.x;
+			last.y = event.y;
+			return;
+		}
+
+		if (event.type == InputEventType::Scroll)
+		{
+			last.time = event.time;
+			last.x += event.x;
+			last.y += event.y;
+			return;
+		}
+	}
+
+	m_Events.push_back(event);
+}
+
+
+auto MC_OpenGL::InputQueue::Report(std::ostream& os) const -> void
+{
+	os << "Input: " << m_Stats.received << " events received, " << m_Stats.dispatched << " handled after coalescing\n";
+}
+
+
+auto MC_OpenGL::InputQueue::Stats() const -> const InputQueueStats&
+{
+	return m_Stats;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+namespace MC_OpenGL
+{
+
+
+	enum class InputEventType : std::uint8_t
+	{
+		CursorEnter,
+		CursorMove,
+		MouseButton,
+		Scroll
+	};
+
+
+	/// <summary> One callback's worth of input. x and y are the cursor position for CursorEnter and
+	/// 		  CursorMove, and the offsets for Scroll. </summary>
+	struct InputEvent
+	{
+		InputEventType	type		= InputEventType::CursorMove;
+		double			time		= 0.;	// glfwGetTime() of the latest callback folded into the event.
+		double			x			= 0.;
+		double			y			= 0.;
+		int				button		= 0;
+		int				action		= 0;
+		int				mods		= 0;
+		int				buttonsDown	= 0;	// CursorMove: bit n set while mouse button n is held.
+	};
+
+
+	/// <summary> Counts since the program started. </summary>
+	struct InputQueueStats
+	{
+		std::size_t		received	= 0;	// Callbacks queued.
+		std::size_t		dispatched	= 0;	// Events drained, after coalescing.
+	};
+
+
+	/// <summary> Input callbacks queue events here instead of acting on them, and the frame handles them
+	/// 		  once after polling. A cursor move right behind another with the same buttons held replaces
+	/// 		  it, and so does a scroll behind a scroll, with the offsets summed; any other event in between
+	/// 		  keeps them apart, so order is kept. </summary>
+	class InputQueue
+	{
+	public:
+		InputQueue() = default;
+
+		/// <summary> Move the queued events to events, oldest first, leaving the queue empty. </summary>
+		auto Drain(std::vector<InputEvent>& events) -> void;
+		auto Push(const InputEvent& event) -> void;
+		auto Report(std::ostream& os) const -> void;
+		auto Stats() const -> const InputQueueStats&;
+
+	private:
+		std::vector<InputEvent>	m_Events;
+		InputQueueStats			m_Stats;
+	};
+
+
+}
@@ -24,12 +24,18 @@
 //#include <stb_image.h>
 
 #include "Camera.h"
+#include "CubeBatch.h"
 #include "DemoTriangle.h"
 #include "Drawable.h"
 #include "ErrorCode.h"
+#include "FrameData.h"
 #include "GLFWCallbackFunctions.h"
+#include "GLState.h"
 #include "GlobalState.h"
+#include "Profiler.h"
 #include "ProjectionOrthographic.h"
+#include "RenderDevice.h"
+#include "RenderQueue.h"
 
 
 std::unique_ptr<MC_OpenGL::GlobalState> pGS;
@@ -185,28 +191,45 @@ int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int n
 		return static_cast<int>(errorCode);
 	}
 
-	glEnable(GL_DEPTH_TEST);
+	MC_OpenGL::Device().Enable(GL_DEPTH_TEST);
+	pGS->programs.Initialize();
+	pGS->shaders.Initialize();
 
+	// Every program is submitted before any is waited for, so the driver can compile them side by side.
+	// Without the ID picker hover falls back to ray casting, so a failure here is not fatal.
+	if (pGS->idPicker.Initialize(pGS->shaders, (int)pGS->windowWidth, (int)pGS->windowHeight) != MC_OpenGL::ErrorCode::NONE)
+		std::cerr << "Error: GPU ID picking is unavailable\n";
 
-	MC_OpenGL::InitDrawables();
 
-	MC_OpenGL::Shader shaderAllWhite(R"(..\shaders\vsBasicCoordinateSystems.glsl)", R"(..\shaders\fsAllWhite.glsl)");
+	MC_OpenGL::Shader shaderAllWhite = pGS->shaders.Submit(R"(..\shaders\vsBasicCoordinateSystems.glsl)", R"(..\shaders\fsAllWhite.glsl)");
 
-	MC_OpenGL::Shader shaderSolidColor(R"(..\shaders\vsBasicCoordinateSystems.glsl)", R"(..\shaders\fsBasicLightColor.glsl)");
-	glUseProgram(shaderSolidColor.GetProgramId());
-	shaderSolidColor.SetVec3("lightColor", glm::vec3(1.f, 1.f, 1.f));
-	shaderSolidColor.SetVec3("objectColor", glm::vec3(0.5f, 0.5f, 1.f));
+	MC_OpenGL::Shader shaderSolidColor = pGS->shaders.Submit(R"(..\shaders\vsBasicCoordinateSystems.glsl)", R"(..\shaders\fsBasicLightColor.glsl)");
 
-	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderAllWhite.GetProgramId(), glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[0])));
-	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor.GetProgramId(), glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[3])));
+	// View, projection and lighting are the same for every draw, so all programs read them from one buffer.
+	MC_OpenGL::FrameUniformBuffer frameUniforms;
+	frameUniforms.Initialize();
+
+	// Cubes drawn with shaderSolidColor all share one mesh, so they go out in a single instanced draw.
+	MC_OpenGL::CubeBatch cubeBatch;
+	cubeBatch.Initialize(pGS->shaders);
+
+	// Everything else is drawn sorted by program, material and vertex array.
+	MC_OpenGL::RenderQueue renderQueue;
+	const MC_OpenGL::RenderQueue::DrawFn drawItem = [](const MC_OpenGL::RenderItem& item) { item.drawable->Draw(item.color); };
+	std::vector<MC_OpenGL::Drawable*> visibleDrawables;
+	pGS->programs.Report(std::cout);
+
+	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderAllWhite, glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[0])));
+	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor, glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[3])));
 	for (int i = 0; i < 10; ++i)
 	{
-		pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor.GetProgramId(), glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[i])));
+		pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor, glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[i])));
 		pGS->drawables.back()->SetColor(glm::vec3(0.5f, 0.5f, 1.f));
 	}
-	//pGS->drawables.push_back(new MC_OpenGL::Triangles(shaderSolidColor, R"(C:\cncm\ncfiles\LT1 090 No Plate.stl)"));
-	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor.GetProgramId(), glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[3])));
-	pGS->projection.ZoomFit(pGS->camera, pGS->drawables, pGS->camera.ViewMatrix());
+	//pGS->drawables.push_back(new MC_OpenGL::Triangles(shaderSolidColor, pGS->geometry, R"(C:\cncm\ncfiles\LT1 090 No Plate.stl)"));
+	//pGS->drawables.push_back(new MC_OpenGL::Cube(shaderSolidColor, glm::translate(glm::mat4(1.f), MC_OpenGL::cubePositions[3])));
+	pGS->sceneIndex.Build(pGS->drawables);
+	pGS->projection.ZoomFit(pGS->camera, pGS->sceneIndex, pGS->camera.ViewMatrix());
 
 
 	// END TEXTURE STUFF
@@ -226,6 +249,7 @@ int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int n
 	// Game loop
 	while (!glfwWindowShouldClose(window))
 	{
+		MC_PROFILE_ZONE("Frame");
 		//auto lightPos = glm::vec3(centroid.x + 6.f * cosf((float)glfwGetTime()), centroid.y + 6.f * sinf((float)glfwGetTime()), -2.f);
 		//glm::mat4 lightModel(1.f);
 		//lightModel = glm::translate(lightModel, lightPos);
@@ -233,26 +257,93 @@ int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int n
 		//pGS->projection.ZoomFit(pGS->drawables, pGS->camera.ViewMatrix(), true);
 
 		//shaderSolidColor.SetVec3("lightPos", lightPos);
-		shaderSolidColor.SetVec3("viewPos", glm::vec3(0.5f*(pGS->projection.GetRight() + pGS->projection.GetLeft()), 0.5f * (pGS->projection.GetTop() + pGS->projection.GetBottom()), 22.f/*abs(pGS->projection.m_Near)*/));
+		MC_OpenGL::FrameData frameData;
+		frameData.view = pGS->camera.ViewMatrix();
+		frameData.projection = pGS->projection.ProjectionMatrix();
+		frameData.viewPos = glm::vec3(0.5f*(pGS->projection.GetRight() + pGS->projection.GetLeft()), 0.5f * (pGS->projection.GetTop() + pGS->projection.GetBottom()), 22.f/*abs(pGS->projection.m_Near)*/);
+		frameData.lightColor = glm::vec3(1.f, 1.f, 1.f);
+		frameUniforms.Update(frameData);
+
+		// Textures decoded since the last frame stream in a slice at a time.
+		pGS->textures.Update();
+		pGS->shaders.Update();
+
+		// ID picking renders the cursor pixel now and uses the result of a readback queued a frame or two ago.
+		bool buttonDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) || glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE);
+		if (pGS->pickMode == MC_OpenGL::PickMode::GpuId && !buttonDown)
+		{
+			MC_PROFILE_ZONE("IdPick");
+			MC_OpenGL::PickResult pick;
+			if (pGS->idPicker.Poll(pick))
+			{
+				if (pGS->hovered != nullptr)
+					pGS->hovered->SetHover(false);
+
+				pGS->hovered = (pick.objectId != 0 && pick.objectId <= pGS->drawables.size()) ? pGS->drawables[pick.objectId - 1] : nullptr;
+				if (pGS->hovered != nullptr)
+					pGS->hovered->SetHover(true);
+			}
+			pGS->idPicker.Render(pGS->drawables, (int)pGS->cursorPosX, (int)pGS->cursorPosY);
+		}
+
+		MC_OpenGL::Device().Viewport(0, 0, (GLsizei)pGS->windowWidth, (GLsizei)pGS->windowHeight);
+		MC_OpenGL::Device().ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		MC_OpenGL::Device().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glViewport(0, 0, (GLsizei)pGS->windowWidth, (GLsizei)pGS->windowHeight);
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// Only what lies in the projection's box is queued.
+		glm::vec3 volumeMin;
+		glm::vec3 volumeMax;
+		pGS->projection.ViewVolume(volumeMin, volumeMax);
+		pGS->culler.Cull(pGS->drawables, frameData.view, volumeMin, volumeMax, visibleDrawables);
 
-		for (const MC_OpenGL::Drawable* drawable : pGS->drawables)
+		const bool cubeBatchReady = cubeBatch.IsReady();
+		cubeBatch.Clear();
+		renderQueue.Clear();
+		for (const MC_OpenGL::Drawable* drawable : visibleDrawables)
 		{
-			if (drawable->GetHover() || drawable->GetSelected())
-				shaderSolidColor.SetVec3("objectColor", glm::vec3(1.f, 1.f, 0.f));
-			else
-				shaderSolidColor.SetVec3("objectColor", drawable->GetColor());
-			drawable->Draw(pGS->camera.ViewMatrix(), pGS->projection.ProjectionMatrix());
+			const bool highlight = drawable->GetHover() || drawable->GetSelected();
+			glm::vec3 color = highlight ? glm::vec3(1.f, 1.f, 0.f) : drawable->GetColor();
+			if (cubeBatchReady && drawable->GetType() == MC_OpenGL::DrawableType::Cube && drawable->GetShaderId() == shaderSolidColor.GetProgramId())
+			{
+				cubeBatch.Add(drawable->ModelMatrix(), color);
+				continue;
+			}
+
+			glm::vec3 center;
+			float radius;
+			drawable->BoundingSphere(center, radius);
+			const float depth = -(frameData.view * glm::vec4(center, 1.f)).z;
+			renderQueue.Add(highlight ? MC_OpenGL::RenderPass::Highlight : MC_OpenGL::RenderPass::Opaque, drawable, color, depth);
 		}
+		renderQueue.Sort();
+		renderQueue.Submit(MC_OpenGL::RenderPass::Opaque, drawItem);
+		cubeBatch.Draw();
+		renderQueue.Submit(MC_OpenGL::RenderPass::Highlight, drawItem);
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		{
+			MC_PROFILE_ZONE("SwapBuffers");
+			glfwSwapBuffers(window);
+		}
+		MC_OpenGL::GLState().EndFrame();
+		{
+			MC_PROFILE_ZONE("PollEvents");
+			glfwPollEvents();
+		}
+
+		// The callbacks only queue mouse input, so hover, pan and rotate run once a frame however fast it comes.
+		MC_OpenGL::ProcessInput(window);
 	}
 
+#ifdef MC_OPENGL_PROFILE
+	MC_OpenGL::WriteProfileTrace(MC_OpenGL::ProfileTraceFilename);
+#endif
+
 	// Clean up and exit
+	cubeBatch.Release();
+	pGS->shaders.Release();
+	frameUniforms.Release();
+	pGS->idPicker.Release();
+	pGS->textures.Release();
 	glfwTerminate();
 
 	return 0;
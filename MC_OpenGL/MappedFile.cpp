@@ -0,0 +1,131 @@
+#include "MappedFile.h"
+
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+
+#ifdef _WIN32
+auto ProcessId() -> unsigned long
+{
+	return GetCurrentProcessId();
+}
+#else
+auto ProcessId() -> unsigned long
+{
+	return static_cast<unsigned long>(getpid());
+}
+#endif
+
+
+}
+
+
+#ifdef _WIN32
+
+
+MC_OpenGL::MappedFile::MappedFile(const std::string& filename)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	m_File = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		return;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+		return;
+	m_Mapping = mapping;
+
+	m_Data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_Data != nullptr)
+		m_Size = static_cast<std::size_t>(size.QuadPart);
+}
+
+
+MC_OpenGL::MappedFile::~MappedFile()
+{
+	if (m_Data != nullptr)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping != nullptr)
+		CloseHandle(m_Mapping);
+	if (m_File != nullptr)
+		CloseHandle(m_File);
+}
+
+
+#else
+
+
+MC_OpenGL::MappedFile::MappedFile(const std::string& filename)
+{
+	m_Fd = open(filename.c_str(), O_RDONLY);
+	if (m_Fd < 0)
+		return;
+
+	struct stat st;
+	if (fstat(m_Fd, &st) != 0 || st.st_size == 0)
+		return;
+
+	void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_Fd, 0);
+	if (data == MAP_FAILED)
+		return;
+
+	madvise(data, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+	m_Data = static_cast<const char*>(data);
+	m_Size = static_cast<std::size_t>(st.st_size);
+}
+
+
+MC_OpenGL::MappedFile::~MappedFile()
+{
+	if (m_Data != nullptr)
+		munmap(const_cast<char*>(m_Data), m_Size);
+	if (m_Fd >= 0)
+		close(m_Fd);
+}
+
+
+#endif
+
+
+MC_OpenGL::MappedFile::operator bool() const
+{
+	return m_Data != nullptr;
+}
+
+
+auto MC_OpenGL::MappedFile::Data() const -> const char*
+{
+	return m_Data;
+}
+
+
+auto MC_OpenGL::MappedFile::Size() const -> std::size_t
+{
+	return m_Size;
+}
+
+
+auto MC_OpenGL::TemporaryPath(const std::filesystem::path& filename) -> std::filesystem::path
+{
+	std::filesystem::path temporary = filename;
+	temporary += '.' + std::to_string(ProcessId()) + '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	return temporary;
+}
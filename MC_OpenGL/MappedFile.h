@@ -0,0 +1,45 @@
+#pragma once
+
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Read-only memory mapping of an entire file. The mapping lives as long as the object. </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+		operator bool() const;
+
+		auto Data() const -> const char*;
+		auto Size() const -> std::size_t;
+
+	private:
+		const char*	m_Data		= nullptr;
+		std::size_t	m_Size		= 0;
+#ifdef _WIN32
+		void*		m_File		= nullptr;
+		void*		m_Mapping	= nullptr;
+#else
+		int			m_Fd		= -1;
+#endif
+	};
+
+
+	/// <summary> A name next to filename that no other thread or process uses, to write a file under before
+	/// 		  renaming it to filename. </summary>
+	auto TemporaryPath(const std::filesystem::path& filename) -> std::filesystem::path;
+
+
+}
@@ -0,0 +1,315 @@
+#include "MeshWeld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "Parallel.h"
+
+
+namespace {
+
+
+// Cell coordinates are clamped to this, which leaves room for the neighbour offsets.
+constexpr double maxCellCoordinate = 4611686018427387904.0;	// 2^62
+
+
+struct Cell
+{
+	std::int64_t x;
+	std::int64_t y;
+	std::int64_t z;
+
+	auto operator==(const Cell& other) const -> bool
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+
+struct CellHash
+{
+	auto operator()(const Cell& cell) const -> std::size_t
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(cell.x) * 0x9E3779B97F4A7C15ull;
+		h ^= static_cast<std::uint64_t>(cell.y) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+		h ^= static_cast<std::uint64_t>(cell.z) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+		return static_cast<std::size_t>(h ^ (h >> 29));
+	}
+};
+
+
+struct CellRange
+{
+	std::uint32_t	begin;		// Range of the cell's vertices in the sorted order.
+	std::uint32_t	end;
+};
+
+
+auto CellLess(const Cell& a, const Cell& b) -> bool
+{
+	if (a.x != b.x)
+		return a.x < b.x;
+	if (a.y != b.y)
+		return a.y < b.y;
+	return a.z < b.z;
+}
+
+
+// Grid coordinate of a finite v for cells of size 1 / invTolerance. Huge coordinates, or tiny tolerances, land
+// in the outermost cells instead of overflowing the cast.
+auto CellCoordinate(float v, float invTolerance) -> std::int64_t
+{
+	const double cell = std::floor(static_cast<double>(v) * invTolerance);
+	if (std::isnan(cell))
+		return 0;
+	return static_cast<std::int64_t>(std::clamp(cell, -maxCellCoordinate, maxCellCoordinate));
+}
+
+
+// Unit normal of vertex i: the stored one, or the facet normal of its triangle when the stored one is zero.
+// Zero when both are, which only happens for degenerate triangles.
+auto UnitNormal(const float* in, std::size_t numVertices, std::size_t floatsPerVertex, std::size_t normalOffset, std::size_t i, float* n) -> void
+{
+	const float* stored = in + i * floatsPerVertex + normalOffset;
+	n[0] = stored[0];
+	n[1] = stored[1];
+	n[2] = stored[2];
+
+	if (n[0] == 0.f && n[1] == 0.f && n[2] == 0.f)
+	{
+		const std::size_t first = i - i % 3;
+		if (first + 2 >= numVertices)
+			return;
+
+		const float* p0 = in + first * floatsPerVertex;
+		const float* p1 = p0 + floatsPerVertex;
+		const float* p2 = p1 + floatsPerVertex;
+		const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if (length > 0.f)
+	{
+		n[0] /= length;
+		n[1] /= length;
+		n[2] /= length;
+	}
+}
+
+
+}
+
+
+auto MC_OpenGL::WeldVertices(const std::vector<float>& vertices, std::size_t floatsPerVertex, std::size_t normalOffset,
+	float positionTolerance, float creaseAngleDegrees, WeldedMesh& welded) -> void
+{
+	welded.vertices.clear();
+	welded.indices.clear();
+
+	const std::size_t numVertices = vertices.size() / floatsPerVertex;
+	if (numVertices == 0)
+		return;
+
+	const float* in = vertices.data();
+	const float tolerance = positionTolerance > 0.f && std::isfinite(positionTolerance) ? positionTolerance : 1e-6f;
+	const float toleranceSquared = tolerance * tolerance;
+	const float invTolerance = 1.f / tolerance;
+	const float cosCrease = std::cos(creaseAngleDegrees * 3.14159265f / 180.f);
+
+	// 1. Find every position's grid cell and a hash bucket for it, and the unit normal to weld by.
+	const std::size_t numBuckets = WorkerCount() * 8;
+	std::vector<Cell> cells(numVertices);
+	std::vector<std::uint32_t> buckets(numVertices);
+	std::vector<float> normals(numVertices * 3);
+	std::vector<std::uint8_t> finite(numVertices);
+	ParallelFor(numVertices, 1 << 15, [&](std::size_t begin, std::size_t end)
+	{
+		CellHash hash;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			// Malformed files carry NaN and infinite positions. They are never welded, and wait in cell 0.
+			const float* p = in + i * floatsPerVertex;
+			finite[i] = std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]);
+			cells[i] = finite[i] ? Cell{ CellCoordinate(p[0], invTolerance), CellCoordinate(p[1], invTolerance), CellCoordinate(p[2], invTolerance) } : Cell{ 0, 0, 0 };
+			buckets[i] = static_cast<std::uint32_t>(hash(cells[i]) % numBuckets);
+			UnitNormal(in, numVertices, floatsPerVertex, normalOffset, i, &normals[3 * i]);
+		}
+	});
+
+	// 2. Stable counting sort of the vertex indices by bucket, so every bucket lists its vertices
+	//    in input order and can be indexed independently of the others.
+	const std::size_t numChunks = std::min(WorkerCount(), std::max<std::size_t>(1, numVertices / (1 << 15)));
+	const std::size_t chunkSize = (numVertices + numChunks - 1) / numChunks;
+	std::vector<std::size_t> counts(numChunks * numBuckets, 0);
+	ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t c = begin; c < end; ++c)
+			for (std::size_t i = c * chunkSize; i < std::min(numVertices, (c + 1) * chunkSize); ++i)
+				++counts[c * numBuckets + buckets[i]];
+	});
+
+	std::vector<std::size_t> offsets(numChunks * numBuckets);
+	std::vector<std::size_t> bucketStart(numBuckets + 1, 0);
+	std::size_t total = 0;
+	for (std::size_t b = 0; b < numBuckets; ++b)
+	{
+		bucketStart[b] = total;
+		for (std::size_t c = 0; c < numChunks; ++c)
+		{
+			offsets[c * numBuckets + b] = total;
+			total += counts[c * numBuckets + b];
+		}
+	}
+	bucketStart[numBuckets] = total;
+
+	std::vector<std::uint32_t> sorted(numVertices);
+	ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t c = begin; c < end; ++c)
+			for (std::size_t i = c * chunkSize; i < std::min(numVertices, (c + 1) * chunkSize); ++i)
+				sorted[offsets[c * numBuckets + buckets[i]]++] = static_cast<std::uint32_t>(i);
+	});
+
+	// 3. Group each bucket's vertices by cell, keeping input order within a cell, and index the cells.
+	std::vector<std::unordered_map<Cell, CellRange, CellHash> > cellRanges(numBuckets);
+	ParallelFor(numBuckets, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t b = begin; b < end; ++b)
+		{
+			std::uint32_t* first = sorted.data() + bucketStart[b];
+			std::uint32_t* last = sorted.data() + bucketStart[b + 1];
+			std::stable_sort(first, last, [&cells](std::uint32_t i, std::uint32_t j) { return CellLess(cells[i], cells[j]); });
+
+			for (std::uint32_t* run = first; run != last; )
+			{
+				std::uint32_t* runEnd = run + 1;
+				while (runEnd != last && cells[*runEnd] == cells[*run])
+					++runEnd;
+
+				cellRanges[b].emplace(cells[*run], CellRange{ static_cast<std::uint32_t>(run - sorted.data()), static_cast<std::uint32_t>(runEnd - sorted.data()) });
+				run = runEnd;
+			}
+		}
+	});
+
+	// 4. Link every vertex to the earliest vertex within tolerance and the crease angle. Positions
+	//    within tolerance of each other are at most one cell apart on each axis, so the 27 cells
+	//    around a vertex hold all its candidates, even when they straddle a cell boundary.
+	std::vector<std::uint32_t> link(numVertices);
+	ParallelFor(numVertices, 1 << 14, [&](std::size_t begin, std::size_t end)
+	{
+		CellHash hash;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const float* p = in + i * floatsPerVertex;
+			const float* n = &normals[3 * i];
+			std::uint32_t found = static_cast<std::uint32_t>(i);
+			if (!finite[i])
+			{
+				link[i] = found;
+				continue;
+			}
+
+			for (std::int64_t dx = -1; dx <= 1; ++dx)
+				for (std::int64_t dy = -1; dy <= 1; ++dy)
+					for (std::int64_t dz = -1; dz <= 1; ++dz)
+					{
+						const Cell cell{ cells[i].x + dx, cells[i].y + dy, cells[i].z + dz };
+						const auto& ranges = cellRanges[hash(cell) % numBuckets];
+						const auto it = ranges.find(cell);
+						if (it == ranges.end())
+							continue;
+
+						// The cell lists its vertices in input order, so stop at the first one not before found.
+						for (std::uint32_t s = it->second.begin; s < it->second.end && sorted[s] < found; ++s)
+						{
+							const std::uint32_t j = sorted[s];
+							if (!finite[j])
+								continue;
+
+							const float* q = in + j * floatsPerVertex;
+							const float d[3] = { p[0] - q[0], p[1] - q[1], p[2] - q[2] };
+							if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] > toleranceSquared)
+								continue;
+
+							// A zero normal, left by a degenerate triangle, does not constrain the weld.
+							const float* m = &normals[3 * j];
+							const bool hasNormals = (n[0] != 0.f || n[1] != 0.f || n[2] != 0.f) && (m[0] != 0.f || m[1] != 0.f || m[2] != 0.f);
+							if (hasNormals && n[0] * m[0] + n[1] * m[1] + n[2] * m[2] < cosCrease)
+								continue;
+
+							found = j;
+							break;
+						}
+					}
+
+			link[i] = found;
+		}
+	});
+
+	// 5. Follow the links to representatives. Links always point to earlier vertices, so one pass in
+	//    input order resolves them. normalSums accumulates the normals of each cluster at its representative.
+	std::vector<std::uint32_t> rep(numVertices);
+	std::vector<float> normalSums(numVertices * 3, 0.f);
+	for (std::size_t i = 0; i < numVertices; ++i)
+	{
+		const std::uint32_t r = link[i] == i ? static_cast<std::uint32_t>(i) : rep[link[i]];
+		rep[i] = r;
+		normalSums[3 * r + 0] += normals[3 * i + 0];
+		normalSums[3 * r + 1] += normals[3 * i + 1];
+		normalSums[3 * r + 2] += normals[3 * i + 2];
+	}
+
+	// 6. Number the representatives in input order and write out the unique vertices and indices.
+	std::vector<std::uint32_t> newIndex(numVertices);
+	std::vector<std::size_t> chunkFirst(numChunks + 1, 0);
+	ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t c = begin; c < end; ++c)
+			for (std::size_t i = c * chunkSize; i < std::min(numVertices, (c + 1) * chunkSize); ++i)
+				chunkFirst[c + 1] += (rep[i] == i) ? 1 : 0;
+	});
+	for (std::size_t c = 0; c < numChunks; ++c)
+		chunkFirst[c + 1] += chunkFirst[c];
+
+	welded.vertices.resize(chunkFirst[numChunks] * floatsPerVertex);
+	welded.indices.resize(numVertices);
+	float* out = welded.vertices.data();
+	ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t c = begin; c < end; ++c)
+		{
+			std::uint32_t next = static_cast<std::uint32_t>(chunkFirst[c]);
+			for (std::size_t i = c * chunkSize; i < std::min(numVertices, (c + 1) * chunkSize); ++i)
+			{
+				if (rep[i] != i)
+					continue;
+
+				newIndex[i] = next;
+				float* v = out + next * floatsPerVertex;
+				std::copy(in + i * floatsPerVertex, in + (i + 1) * floatsPerVertex, v);
+
+				const float* sum = &normalSums[3 * i];
+				float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				if (length > 0.f)
+				{
+					v[normalOffset + 0] = sum[0] / length;
+					v[normalOffset + 1] = sum[1] / length;
+					v[normalOffset + 2] = sum[2] / length;
+				}
+				++next;
+			}
+		}
+	});
+
+	ParallelFor(numVertices, 1 << 16, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			welded.indices[i] = newIndex[rep[i]];
+	});
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace MC_OpenGL
+{
+
+
+	struct WeldedMesh
+	{
+		std::vector<float>			vertices;	// Unique vertices, same layout as the input.
+		std::vector<std::uint32_t>	indices;	// Three per triangle, into vertices.
+	};
+
+
+	/// <summary> Merge the duplicate vertices of a non-indexed triangle soup into an indexed mesh. </summary>
+	///
+	/// <remarks> Positions are bucketed in a grid with a cell size of positionTolerance, and each vertex
+	/// 		  looks for partners in its own and the 26 neighbouring cells. It is merged with the earliest
+	/// 		  vertex within positionTolerance whose normal is within creaseAngleDegrees of its own, so
+	/// 		  hard edges keep their facet normals; merged vertices get the averaged normal. A zero normal,
+	/// 		  as many STL writers leave them, is replaced by the facet normal from the triangle's edges,
+	/// 		  taking every three consecutive vertices as a triangle. The first occurrence of each vertex
+	/// 		  determines the output order. Vertices with a NaN or infinite coordinate are kept but never
+	/// 		  merged. </remarks>
+	///
+	/// <param name="vertices">			  Interleaved vertices, floatsPerVertex each. Position is at offset 0,
+	/// 								  the normal at offset normalOffset. </param>
+	/// <param name="floatsPerVertex">	  Stride of one vertex in floats. </param>
+	/// <param name="normalOffset">		  Offset of the normal within a vertex in floats. </param>
+	/// <param name="positionTolerance">  Positions closer than this are considered the same. </param>
+	/// <param name="creaseAngleDegrees"> Largest angle between normals that still get merged. </param>
+	/// <param name="welded">			  [out] The indexed mesh. </param>
+	auto WeldVertices(const std::vector<float>& vertices, std::size_t floatsPerVertex, std::size_t normalOffset,
+		float positionTolerance, float creaseAngleDegrees, WeldedMesh& welded) -> void;
+
+
+}
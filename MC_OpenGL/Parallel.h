@@ -0,0 +1,54 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Number of worker threads to split CPU bound work across. </summary>
+	inline auto WorkerCount() -> std::size_t
+	{
+		return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+
+
+	/// <summary> Split [0, count) into contiguous ranges of at least minChunk elements and call
+	/// 		  fn(begin, end) for each range on its own thread. Blocks until all ranges are done. </summary>
+	template <typename Fn>
+	auto ParallelFor(std::size_t count, std::size_t minChunk, Fn fn) -> void
+	{
+		if (count == 0)
+			return;
+
+		std::size_t numChunks = std::min(WorkerCount(), std::max<std::size_t>(1, count / std::max<std::size_t>(1, minChunk)));
+		if (numChunks == 1)
+		{
+			fn(std::size_t(0), count);
+			return;
+		}
+
+		std::size_t chunkSize = (count + numChunks - 1) / numChunks;
+
+		std::vector<std::future<void> > futures;
+		futures.reserve(numChunks - 1);
+		for (std::size_t begin = chunkSize; begin < count; begin += chunkSize)
+		{
+			std::size_t end = std::min(count, begin + chunkSize);
+			futures.push_back(std::async(std::launch::async, [&fn, begin, end]() { fn(begin, end); }));
+		}
+
+		fn(std::size_t(0), std::min(count, chunkSize));
+
+		for (auto& future : futures)
+			future.get();
+	}
+
+
+}
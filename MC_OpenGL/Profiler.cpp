@@ -0,0 +1,161 @@
+#include "Profiler.h"
+
+
+#ifdef MC_OPENGL_PROFILE
+
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace {
+
+
+constexpr std::size_t ringSize = 1 << 14;
+
+
+struct ZoneEvent
+{
+	const char*		name		= nullptr;
+	std::int64_t	start		= 0;	// Nanoseconds since the first zone.
+	std::int64_t	end			= 0;
+	std::uint32_t	threadId	= 0;	// Of the thread that owned the ring then; rings outlive their threads.
+};
+
+
+// Owned by one thread at a time. written counts every zone recorded; the ring keeps the last ringSize. The
+// mutex is only ever contended while WriteProfileTrace copies the ring.
+struct ThreadRing
+{
+	std::mutex						mutex;
+	std::uint32_t					threadId	= 0;
+	std::array<ZoneEvent, ringSize>	events;
+	std::uint64_t					written		= 0;
+};
+
+
+struct Registry
+{
+	std::mutex									mutex;
+	std::vector<std::unique_ptr<ThreadRing>>	rings;
+	std::vector<ThreadRing*>					idle;			// Rings of exited threads, handed to new ones.
+	std::uint32_t								lastThreadId	= 0;
+};
+
+
+auto GetRegistry() -> Registry&
+{
+	static Registry registry;
+	return registry;
+}
+
+
+// ParallelFor starts fresh threads on every call, so rings go back to the registry when their thread exits
+// instead of piling up. Their zones stay in the trace, under the old thread's id, until the next owner
+// overwrites them.
+struct RingLease
+{
+	ThreadRing* ring = nullptr;
+
+	RingLease()
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		if (!registry.idle.empty())
+		{
+			ring = registry.idle.back();
+			registry.idle.pop_back();
+		}
+		else
+		{
+			registry.rings.push_back(std::make_unique<ThreadRing>());
+			ring = registry.rings.back().get();
+		}
+		ring->threadId = ++registry.lastThreadId;
+	}
+
+	~RingLease()
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.idle.push_back(ring);
+	}
+};
+
+
+auto ThisThreadRing() -> ThreadRing&
+{
+	thread_local RingLease lease;
+	return *lease.ring;
+}
+
+
+auto Now() -> std::int64_t
+{
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+
+}
+
+
+MC_OpenGL::ProfileZone::ProfileZone(const char* name)
+	:	m_Name(name),
+		m_Start(Now())
+{
+}
+
+
+MC_OpenGL::ProfileZone::~ProfileZone()
+{
+	const std::int64_t end = Now();
+	ThreadRing& ring = ThisThreadRing();
+	std::lock_guard<std::mutex> lock(ring.mutex);
+	ring.events[ring.written & (ringSize - 1)] = { m_Name, m_Start, end, ring.threadId };
+	++ring.written;
+}
+
+
+auto MC_OpenGL::WriteProfileTrace(const std::string& filename) -> bool
+{
+	// Each ring is copied under its own lock, so its thread waits for the copy rather than overwriting
+	// zones while they are read. Formatting and writing happen after every lock is released.
+	std::vector<ZoneEvent> events;
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (const std::unique_ptr<ThreadRing>& ring : registry.rings)
+		{
+			std::lock_guard<std::mutex> ringLock(ring->mutex);
+			const std::uint64_t end = ring->written;
+			for (std::uint64_t i = end > ringSize ? end - ringSize : 0; i < end; ++i)
+				events.push_back(ring->events[i & (ringSize - 1)]);
+		}
+	}
+
+	std::ofstream ofs(filename);
+	if (!ofs)
+		return false;
+
+	ofs << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+	bool first = true;
+	for (const ZoneEvent& event : events)
+	{
+		ofs << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+			<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << '}';
+		first = false;
+	}
+
+	ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return static_cast<bool>(ofs);
+}
+
+
+#endif
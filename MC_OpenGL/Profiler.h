@@ -0,0 +1,55 @@
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+
+
+// Zones cost nothing unless MC_OPENGL_PROFILE is defined; the Debug and Profile configurations define it,
+// and Profile is Release otherwise. Zone names must be string literals, since only the pointer is kept.
+#ifdef MC_OPENGL_PROFILE
+#define MC_PROFILE_CONCAT_(a, b) a##b
+#define MC_PROFILE_CONCAT(a, b) MC_PROFILE_CONCAT_(a, b)
+#define MC_PROFILE_ZONE(name) const MC_OpenGL::ProfileZone MC_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define MC_PROFILE_ZONE(name) ((void)0)
+#endif
+
+
+#ifdef MC_OPENGL_PROFILE
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Where F12 and exiting the program write the trace, relative to the working directory. </summary>
+	constexpr const char* ProfileTraceFilename = "MC_OpenGL_trace.json";
+
+
+	/// <summary> Times the scope it lives in and records it in the calling thread's ring buffer, which
+	/// 		  keeps the most recent 16384 zones of that thread. Use through MC_PROFILE_ZONE. </summary>
+	class ProfileZone
+	{
+	public:
+		explicit ProfileZone(const char* name);
+		ProfileZone(const ProfileZone&) = delete;
+		auto operator=(const ProfileZone&) -> ProfileZone& = delete;
+		~ProfileZone();
+
+	private:
+		const char*		m_Name;
+		std::int64_t	m_Start;
+	};
+
+
+	/// <summary> Write the zones every thread still holds to filename in the Chrome trace event format,
+	/// 		  for chrome://tracing or Perfetto. Zones other threads finish while this runs may be left
+	/// 		  out. False if the file cannot be written. </summary>
+	auto WriteProfileTrace(const std::string& filename) -> bool;
+
+
+}
+
+
+#endif
@@ -0,0 +1,229 @@
+#include "ProgramCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+#include "MappedFile.h"
+
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+
+namespace {
+
+
+constexpr char			entryMagic[4]	= { 'M', 'C', 'P', 'B' };
+constexpr std::uint32_t	entryVersion	= 2;
+
+
+// File layout: header, then size bytes of driver specific binary.
+struct EntryHeader
+{
+	char			magic[4];
+	std::uint32_t	version;
+	std::uint64_t	keyLow;
+	std::uint64_t	keyHigh;
+	std::uint32_t	format;
+	std::uint32_t	size;
+};
+
+
+auto GetString(GLenum name) -> std::string
+{
+	const GLubyte* value = glGetString(name);
+	return value != nullptr ? reinterpret_cast<const char*>(value) : "";
+}
+
+
+}
+
+
+MC_OpenGL::ProgramCache::ProgramCache(const std::filesystem::path& cacheDirectory)
+	: m_CacheDirectory(cacheDirectory)
+{
+}
+
+
+auto MC_OpenGL::ProgramCache::EntryPath(const ContentHash& key) const -> std::filesystem::path
+{
+	return m_CacheDirectory / (HashToHex(key) + ".mcpb");
+}
+
+
+auto MC_OpenGL::ProgramCache::Initialize() -> void
+{
+	m_Driver = GetString(GL_VENDOR) + '\n' + GetString(GL_RENDERER) + '\n' + GetString(GL_VERSION);
+
+	// The loader is only generated for 3.3, so the 4.1 entry points are looked up here.
+	GLint major = 0;
+	GLint minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if ((major > 4 || (major == 4 && minor >= 1)) || glfwExtensionSupported("GL_ARB_get_program_binary"))
+	{
+		m_GetProgramBinary = reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+		m_ProgramBinary = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+		m_ProgramParameteri = reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+	}
+
+	// Some drivers expose the functions but support no binary format at all.
+	GLint numFormats = 0;
+	if (m_GetProgramBinary != nullptr)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	if (numFormats <= 0 || m_ProgramBinary == nullptr || m_ProgramParameteri == nullptr)
+	{
+		m_GetProgramBinary = nullptr;
+		m_ProgramBinary = nullptr;
+		m_ProgramParameteri = nullptr;
+	}
+}
+
+
+auto MC_OpenGL::ProgramCache::Key(const std::string& vsSource, const std::string& fsSource) const -> ContentHash
+{
+	std::string text;
+	text.reserve(vsSource.size() + fsSource.size() + m_Driver.size() + 2);
+	text.append(vsSource).append(1, '\0').append(fsSource).append(1, '\0').append(m_Driver);
+	return HashBytes(text.data(), text.size());
+}
+
+
+auto MC_OpenGL::ProgramCache::Load(const ContentHash& key) -> GLuint
+{
+	if (m_ProgramBinary == nullptr)
+	{
+		++m_Stats.misses;
+		return 0;
+	}
+
+	const std::filesystem::path filename = EntryPath(key);
+	GLuint program = 0;
+	{
+		MappedFile file(filename.string());
+		EntryHeader header;
+		if (!file || file.Size() < sizeof(header))
+		{
+			++m_Stats.misses;
+			return 0;
+		}
+
+		std::memcpy(&header, file.Data(), sizeof(header));
+		if (std::memcmp(header.magic, entryMagic, sizeof(entryMagic)) != 0 || header.version != entryVersion || header.keyLow != key.low || header.keyHigh != key.high
+			|| header.size != file.Size() - sizeof(header))
+		{
+			++m_Stats.misses;
+			return 0;
+		}
+
+		program = glCreateProgram();
+		m_ProgramBinary(program, header.format, file.Data() + sizeof(header), static_cast<GLsizei>(header.size));
+	}
+
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (success)
+	{
+		++m_Stats.hits;
+		return program;
+	}
+
+	// Drivers may refuse binaries of older builds even with unchanged version strings. The file is unmapped
+	// by now, so it can be deleted and rewritten once the program is linked from source.
+	glDeleteProgram(program);
+	std::error_code error;
+	std::filesystem::remove(filename, error);
+	++m_Stats.rejected;
+	++m_Stats.misses;
+	return 0;
+}
+
+
+auto MC_OpenGL::ProgramCache::PrepareLink(GLuint program) const -> void
+{
+	if (m_ProgramParameteri != nullptr)
+		m_ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+
+auto MC_OpenGL::ProgramCache::Report(std::ostream& os) const -> void
+{
+	os << "Programs: " << m_Stats.hits << " cache hits, " << m_Stats.misses << " compiled (" << m_Stats.rejected
+		<< " rejected binaries), " << m_Stats.stores << " stored";
+	if (m_GetProgramBinary == nullptr)
+		os << ", binaries unsupported";
+	os << '\n';
+}
+
+
+auto MC_OpenGL::ProgramCache::Stats() const -> const ProgramCacheStats&
+{
+	return m_Stats;
+}
+
+
+auto MC_OpenGL::ProgramCache::Store(const ContentHash& key, GLuint program) -> void
+{
+	if (m_GetProgramBinary == nullptr)
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(static_cast<std::size_t>(length));
+	EntryHeader header;
+	std::memcpy(header.magic, entryMagic, sizeof(entryMagic));
+	header.version = entryVersion;
+	header.keyLow = key.low;
+	header.keyHigh = key.high;
+	GLsizei written = 0;
+	GLenum format = GL_NONE;
+	m_GetProgramBinary(program, length, &written, &format, binary.data());
+	if (written <= 0)
+		return;
+	header.format = format;
+	header.size = static_cast<std::uint32_t>(written);
+
+	std::error_code error;
+	std::filesystem::create_directories(m_CacheDirectory, error);
+
+	// Written under a name of this writer's own and renamed, so a reader never maps a half written entry and
+	// concurrent writers of the same entry never write into one file.
+	const std::filesystem::path filename = EntryPath(key);
+	const std::filesystem::path temporary = TemporaryPath(filename);
+	{
+		std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(binary.data(), written);
+		ofs.close();
+		if (!ofs)
+		{
+			std::filesystem::remove(temporary, error);
+			std::cerr << "Warning: failed to write program cache " << filename.string() << '\n';
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporary, filename, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		std::cerr << "Warning: failed to write program cache " << filename.string() << '\n';
+		return;
+	}
+	++m_Stats.stores;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "Hash.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	struct ProgramCacheStats
+	{
+		std::size_t		hits		= 0;	// Programs loaded from a binary instead of being compiled.
+		std::size_t		misses		= 0;	// Programs compiled from source, including rejected binaries.
+		std::size_t		rejected	= 0;	// Binaries the driver would not load; their files are deleted.
+		std::size_t		stores		= 0;
+	};
+
+
+	/// <summary> Linked program binaries kept on disk, so that a launch only compiles GLSL that changed. An
+	/// 		  entry is keyed by a hash of both shader sources and the driver's vendor, renderer and version
+	/// 		  strings, so edited shaders and driver updates simply miss. Needs GL 4.1 or
+	/// 		  ARB_get_program_binary; without it every lookup misses and nothing is stored. </summary>
+	class ProgramCache
+	{
+	public:
+		ProgramCache(const ProgramCache&) = delete;
+		auto operator=(const ProgramCache&) -> ProgramCache& = delete;
+
+		ProgramCache(const std::filesystem::path& cacheDirectory = R"(..\shaders\cache)");
+
+		/// <summary> Look up the entry points and the driver strings. Call once the context is current and
+		/// 		  before the first program is built. </summary>
+		auto Initialize() -> void;
+		auto Key(const std::string& vsSource, const std::string& fsSource) const -> ContentHash;
+
+		/// <summary> A linked program made from the binary stored for key, or 0 when there is none or the
+		/// 		  driver rejects it. The caller then links from source. </summary>
+		auto Load(const ContentHash& key) -> GLuint;
+
+		/// <summary> Ask the driver to keep the binary of program. Call before glLinkProgram. </summary>
+		auto PrepareLink(GLuint program) const -> void;
+
+		/// <summary> Print how many programs came from the cache and how many were compiled. </summary>
+		auto Report(std::ostream& os) const -> void;
+		auto Stats() const -> const ProgramCacheStats&;
+
+		/// <summary> Write the binary of a program linked from source. A failed write only costs the next
+		/// 		  launch a compile. </summary>
+		auto Store(const ContentHash& key, GLuint program) -> void;
+
+	private:
+		using GetProgramBinaryProc = void (APIENTRY*)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+		using ProgramBinaryProc = void (APIENTRY*)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+		using ProgramParameteriProc = void (APIENTRY*)(GLuint program, GLenum pname, GLint value);
+
+		auto EntryPath(const ContentHash& key) const -> std::filesystem::path;
+
+		std::filesystem::path	m_CacheDirectory;
+		std::string				m_Driver;
+		GetProgramBinaryProc	m_GetProgramBinary	= nullptr;
+		ProgramBinaryProc		m_ProgramBinary		= nullptr;
+		ProgramParameteriProc	m_ProgramParameteri	= nullptr;
+		ProgramCacheStats		m_Stats;
+	};
+
+
+}
@@ -1,37 +1,31 @@
 #include "ProjectionOrthographic.h"
 
+#include <cmath>
+
 #include "Drawable.h"
 #include "GlobalState.h"
+#include "Profiler.h"
 
 
 MC_OpenGL::ProjectionOrthographic::ProjectionOrthographic()
 {
+	UpdateMatrices();
 }
 
 
-auto MC_OpenGL::ProjectionOrthographic::AutoCenter(const MC_OpenGL::Camera &camera, const std::vector<Drawable*>& drawables, const glm::mat4& viewMatrix) -> void
+auto MC_OpenGL::ProjectionOrthographic::AutoCenter(const MC_OpenGL::Camera &camera, const SceneIndex& sceneIndex, const glm::mat4& viewMatrix) -> void
 {
-	float x0 = std::numeric_limits<float>::max();
-	float y0 = std::numeric_limits<float>::max();
-	float z0 = std::numeric_limits<float>::max();
-	float x1 = std::numeric_limits<float>::lowest();
-	float y1 = std::numeric_limits<float>::lowest();
-	float z1 = std::numeric_limits<float>::lowest();
-	for (int i = 0; i < drawables.size(); ++i)
-	{
-		const auto& drawable = drawables[i];
-		const auto& boundingBox = drawable->BoundingBox();
-		for (int j = 0; j < boundingBox.size(); ++j)
-		{
-			glm::vec3 ptEyeSpace = viewMatrix * drawable->ModelMatrix() * glm::vec4(boundingBox[j], 1.f);
-			x0 = std::min(x0, ptEyeSpace.x);
-			y0 = std::min(y0, ptEyeSpace.y);
-			x1 = std::max(x1, ptEyeSpace.x);
-			y1 = std::max(y1, ptEyeSpace.y);
-			z0 = std::min(z0, ptEyeSpace.z);
-			z1 = std::max(z1, ptEyeSpace.z);
-		}
-	}
+	MC_PROFILE_ZONE("AutoCenter");
+	glm::vec3 eyeMin;
+	glm::vec3 eyeMax;
+	sceneIndex.Extents(viewMatrix, eyeMin, eyeMax);
+
+	float x0 = eyeMin.x;
+	float y0 = eyeMin.y;
+	float z0 = eyeMin.z;
+	float x1 = eyeMax.x;
+	float y1 = eyeMax.y;
+	float z1 = eyeMax.z;
 
 	float cx = 0.5f * (x0 + x1);
 	float cy = 0.5f * (y0 + y1);
@@ -88,6 +82,12 @@ auto MC_OpenGL::ProjectionOrthographic::GetTop () -> double
 	}
 
 
+auto MC_OpenGL::ProjectionOrthographic::InverseProjectionMatrix() const -> const glm::mat4&
+{
+	return m_InverseProjection;
+}
+
+
 auto MC_OpenGL::ProjectionOrthographic::Pan(float cursorDx, float cursorDy) -> void
 {
 	float projDx = m_Right - m_Left;
@@ -101,12 +101,13 @@ auto MC_OpenGL::ProjectionOrthographic::Pan(float cursorDx, float cursorDy) -> v
 	m_Right		= m_Right	- cursorDx * (projDx) / static_cast<float>(windowWidth);
 	m_Bottom	= m_Bottom	+ cursorDy * (projDy) / static_cast<float>(windowHeight);
 	m_Top		= m_Top		+ cursorDy * (projDy) / static_cast<float>(windowHeight);
+	UpdateMatrices();
 }
 
 
-auto MC_OpenGL::ProjectionOrthographic::ProjectionMatrix() const -> glm::mat4
+auto MC_OpenGL::ProjectionOrthographic::ProjectionMatrix() const -> const glm::mat4&
 {
-	return glm::ortho(m_Left, m_Right, m_Bottom, m_Top, m_Near, m_Far);
+	return m_Projection;
 }
 
 
@@ -134,10 +135,19 @@ auto MC_OpenGL::ProjectionOrthographic::SetWindow (GLFWwindow *window) -> void
 }
 
 
+auto MC_OpenGL::ProjectionOrthographic::UpdateMatrices() -> void
+{
+	m_Projection = glm::ortho(m_Left, m_Right, m_Bottom, m_Top, m_Near, m_Far);
+	m_InverseProjection = glm::inverse(m_Projection);
+	++m_Version;
+}
+
+
 auto MC_OpenGL::ProjectionOrthographic::UpdateProjectionMatrix(float zNear, float zFar) -> void
 {
 	m_Near = zNear;
 	m_Far = zFar;
+	UpdateMatrices();
 }
 
 
@@ -163,35 +173,36 @@ auto MC_OpenGL::ProjectionOrthographic::UpdateProjectionMatrix(float aspectRatio
 		m_Near = zNear;
 		m_Far = zFar;
 	}
+	UpdateMatrices();
 }
 
 
-auto MC_OpenGL::ProjectionOrthographic::ZoomFit(const MC_OpenGL::Camera &camera, const std::vector<Drawable *> &drawables, const glm::mat4 &viewMatrix, bool fitZOnly) -> void
+auto MC_OpenGL::ProjectionOrthographic::Version() const -> std::uint64_t
 {
-	float x0 = std::numeric_limits<float>::max();
-	float y0 = std::numeric_limits<float>::max();
-	float z0 = std::numeric_limits<float>::max();
-	float x1 = std::numeric_limits<float>::lowest();
-	float y1 = std::numeric_limits<float>::lowest();
-	float z1 = std::numeric_limits<float>::lowest();
-	for (int i = 0; i < drawables.size(); ++i)
-	{
-		const auto &drawable = drawables[i];
-		const auto &boundingBox = drawable->BoundingBox ();
-		for (int j = 0; j < boundingBox.size(); ++j)
-		{
-			glm::vec3 ptEyeSpace = viewMatrix * drawable->ModelMatrix() * glm::vec4(boundingBox[j], 1.f);
-			if (!fitZOnly)
-			{
-				x0 = std::min(x0, ptEyeSpace.x);
-				y0 = std::min(y0, ptEyeSpace.y);
-				x1 = std::max(x1, ptEyeSpace.x);
-				y1 = std::max(y1, ptEyeSpace.y);
-			}
-			z0 = std::min(z0, ptEyeSpace.z);
-			z1 = std::max(z1, ptEyeSpace.z);
-		}
-	}
+	return m_Version;
+}
+
+
+auto MC_OpenGL::ProjectionOrthographic::ViewVolume(glm::vec3& min, glm::vec3& max) const -> void
+{
+	min = glm::vec3(m_Left, m_Bottom, -m_Far);
+	max = glm::vec3(m_Right, m_Top, -m_Near);
+}
+
+
+auto MC_OpenGL::ProjectionOrthographic::ZoomFit(const MC_OpenGL::Camera &camera, const SceneIndex &sceneIndex, const glm::mat4 &viewMatrix, bool fitZOnly) -> void
+{
+	MC_PROFILE_ZONE("ZoomFit");
+	glm::vec3 eyeMin;
+	glm::vec3 eyeMax;
+	sceneIndex.Extents(viewMatrix, eyeMin, eyeMax);
+
+	float x0 = eyeMin.x;
+	float y0 = eyeMin.y;
+	float z0 = eyeMin.z;
+	float x1 = eyeMax.x;
+	float y1 = eyeMax.y;
+	float z1 = eyeMax.z;
 
 	float cx = 0.5f * (x0 + x1);
 	float cy = 0.5f * (y0 + y1);
@@ -206,69 +217,29 @@ auto MC_OpenGL::ProjectionOrthographic::ZoomFit(const MC_OpenGL::Camera &camera,
 	float zNear = (camera.ViewMatrix()*glm::vec4(camera.m_Eye, 1.f)).z - z1 - 1.f;
 	float zFar = (camera.ViewMatrix()*glm::vec4(camera.m_Eye, 1.f)).z - z0 + 1.f;
 
-	int windowWidth;
-	int windowHeight;
-	glfwGetWindowSize(m_Window, &windowWidth, &windowHeight);
-
+	// Rotating refits z on every cursor move, and that needs no window size.
 	if (fitZOnly)
+	{
 		UpdateProjectionMatrix(zNear, zFar);
-	else
-		UpdateProjectionMatrix((float)windowWidth/(float)windowHeight, cx, cy, dx, dy, zNear, zFar);
-}
-
-
-auto MC_OpenGL::ProjectionOrthographic::ZoomInOutToCursor(float offset) -> void
-{
-	double xpos;
-	double ypos;
-	glfwGetCursorPos(m_Window, &xpos, &ypos);
-
-	int xwid;
-	int ywid;
-	glfwGetWindowSize(m_Window, &xwid, &ywid);
-
-	float xpct = xpos / xwid;
-	float ypct = ypos / ywid;
-
-	float xPctProj = m_Left		+ xpct * (m_Right	- m_Left);
-	float yPctProj = m_Bottom	+ ypct * (m_Top		- m_Bottom);
-
-	ZoomInOut(offset);
-
-	float newXPctProj = m_Left		+ xpct * (m_Right	- m_Left);
-	float newYPctProj = m_Bottom	+ ypct * (m_Top		- m_Bottom);
-
-	float xShift = newXPctProj - xPctProj;
-	float yShift = newYPctProj - yPctProj;
-
-	float xShiftPct = xShift / (m_Right	- m_Left);
-	float yShiftPct = yShift / (m_Top	- m_Bottom);
-	
-	xShiftPct *= xwid;
-	yShiftPct *= ywid;
+		return;
+	}
 
-	Pan(xShiftPct, yShiftPct);
+	int windowWidth;
+	int windowHeight;
+	glfwGetWindowSize(m_Window, &windowWidth, &windowHeight);
+	UpdateProjectionMatrix((float)windowWidth/(float)windowHeight, cx, cy, dx, dy, zNear, zFar);
 }
 
 
-auto MC_OpenGL::ProjectionOrthographic::ZoomInOut(float offset) -> void
+auto MC_OpenGL::ProjectionOrthographic::ZoomInOutToCursor(float offset, const glm::vec2& cursor) -> void
 {
-	double cx = (m_Left + m_Right) / 2.f;
-	double cy = (m_Bottom + m_Top) / 2.f;
-
-	float dx = m_Right - m_Left;
-	float dy = m_Top - m_Bottom;
-
-	if (offset > 0)
-	{
-		dx *= 0.9f;
-		dy *= 0.9f;
-	}
-	else if (offset < 0)
-	{
-		dx *= 1.1f;
-		dy *= 1.1f;
-	}
-
-	UpdateProjectionMatrix(dx/dy, cx, cy, dx, dy, m_Near, m_Far);
+	MC_PROFILE_ZONE("ZoomInOutToCursor");
+
+	// A power rather than one step per call, so that scrolls summed into one offset zoom as far as separate ones.
+	const float scale = offset > 0.f ? std::pow(0.9f, offset) : std::pow(1.1f, -offset);
+	m_Left		= cursor.x + (m_Left	- cursor.x) * scale;
+	m_Right		= cursor.x + (m_Right	- cursor.x) * scale;
+	m_Bottom	= cursor.y + (m_Bottom	- cursor.y) * scale;
+	m_Top		= cursor.y + (m_Top		- cursor.y) * scale;
+	UpdateMatrices();
 }
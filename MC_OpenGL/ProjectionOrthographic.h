@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
@@ -12,6 +13,7 @@
 
 #include "Camera.h"
 #include "Drawable.h"
+#include "SceneIndex.h"
 
 
 namespace MC_OpenGL
@@ -26,24 +28,38 @@ namespace MC_OpenGL
 	public:
 		ProjectionOrthographic();
 
-		auto AutoCenter(const MC_OpenGL::Camera &camera, const std::vector<Drawable*>& drawables, const glm::mat4& viewMatrix) -> void;
+		auto AutoCenter(const MC_OpenGL::Camera &camera, const SceneIndex& sceneIndex, const glm::mat4& viewMatrix) -> void;
 		auto GetBottom () -> double;
 		auto GetFar () -> double;
 		auto GetLeft () -> double;
 		auto GetNear () -> double;
 		auto GetRight () -> double;
 		auto GetTop () -> double;
+
+		/// <summary> Inverse of ProjectionMatrix(), computed when the projection changes. </summary>
+		auto InverseProjectionMatrix() const -> const glm::mat4&;
 		auto Pan(float cursorDx, float cursorDy) -> void;
-		auto ProjectionMatrix () const -> glm::mat4;
+		auto ProjectionMatrix () const -> const glm::mat4&;
 		auto Resize(float oldWidth, float oldHeight, float newWidth, float newHeight) -> void;
 		auto SetWindow (GLFWwindow *window) -> void;
-		auto ZoomFit(const MC_OpenGL::Camera &camera, const std::vector<Drawable *> &drawables, const glm::mat4 &viewMatrix, bool fitZOnly = false) -> void;
-		auto ZoomInOutToCursor(float offset) -> void;
+		auto ZoomFit(const MC_OpenGL::Camera &camera, const SceneIndex &sceneIndex, const glm::mat4 &viewMatrix, bool fitZOnly = false) -> void;
+
+		/// <summary> Zoom in for a positive offset and out for a negative one, by 10% per unit, keeping the
+		/// 		  view space point cursor where it is on screen. </summary>
+		auto ZoomInOutToCursor(float offset, const glm::vec2& cursor) -> void;
+
+		/// <summary> Changes whenever the projection matrix does. </summary>
+		auto Version() const -> std::uint64_t;
+
+		/// <summary> The box the projection shows, in view space. The camera looks down -z, so near and far
+		/// 		  become -m_Near and -m_Far. </summary>
+		auto ViewVolume(glm::vec3& min, glm::vec3& max) const -> void;
 
 	private:
+		// Every change to the bounds below ends here.
+		auto UpdateMatrices() -> void;
 		auto UpdateProjectionMatrix(float zNear, float zFar) -> void;
 		auto UpdateProjectionMatrix(float aspectRatio, float cx, float cy, float dx, float dy, float zNear, float zFar) -> void;
-		auto ZoomInOut(float offset) -> void;
 
 		float m_Left			= -400.f;
 		float m_Right			=  400.f;
@@ -52,6 +68,9 @@ namespace MC_OpenGL
 		float m_Near			=    0.1f;
 		float m_Far				=  100.f;
 		GLFWwindow *m_Window	= nullptr;
+		glm::mat4 m_Projection			= glm::mat4(1.f);
+		glm::mat4 m_InverseProjection	= glm::mat4(1.f);
+		std::uint64_t m_Version			= 0;
 	};
 
 
@@ -0,0 +1,435 @@
+#include "RayTriangle.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MC_TARGET(isa)
+#pragma fp_contract (off)
+#else
+#include <cpuid.h>
+#define MC_TARGET(isa) __attribute__((target(isa)))
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+
+// Every kernel evaluates exactly the same sequence of IEEE operations per triangle, in the same order
+// and without fused multiply-adds, which is what makes the SIMD results identical to the scalar ones.
+
+
+namespace {
+
+
+auto Cpuid(int leaf, int subleaf, unsigned int regs[4]) -> void
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex(r, leaf, subleaf);
+	for (int i = 0; i < 4; ++i)
+		regs[i] = static_cast<unsigned int>(r[i]);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+
+auto Xgetbv() -> unsigned long long
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int lo;
+	unsigned int hi;
+	__asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+
+
+auto ScalarTriangles(const MC_OpenGL::TriangleView& tri, std::size_t first, std::size_t count,
+	const glm::vec3& o, const glm::vec3& d, float& tBest, std::uint32_t& triangle) -> bool
+{
+	bool found = false;
+	for (std::size_t i = first; i < first + count; ++i)
+	{
+		const float x0 = tri.coords[0][i];
+		const float y0 = tri.coords[1][i];
+		const float z0 = tri.coords[2][i];
+
+		const float e1x = tri.coords[3][i] - x0;
+		const float e1y = tri.coords[4][i] - y0;
+		const float e1z = tri.coords[5][i] - z0;
+		const float e2x = tri.coords[6][i] - x0;
+		const float e2y = tri.coords[7][i] - y0;
+		const float e2z = tri.coords[8][i] - z0;
+
+		const float px = d.y * e2z - d.z * e2y;
+		const float py = d.z * e2x - d.x * e2z;
+		const float pz = d.x * e2y - d.y * e2x;
+		const float det = (e1x * px + e1y * py) + e1z * pz;
+
+		const float sx = o.x - x0;
+		const float sy = o.y - y0;
+		const float sz = o.z - z0;
+
+		const float qx = sy * e1z - sz * e1y;
+		const float qy = sz * e1x - sx * e1z;
+		const float qz = sx * e1y - sy * e1x;
+
+		const float invDet = 1.f / det;
+		const float u = ((sx * px + sy * py) + sz * pz) * invDet;
+		const float v = ((d.x * qx + d.y * qy) + d.z * qz) * invDet;
+		const float t = ((e2x * qx + e2y * qy) + e2z * qz) * invDet;
+
+		if (det != 0.f && u >= 0.f && v >= 0.f && (u + v) <= 1.f && t >= 0.f && t < tBest)
+		{
+			tBest = t;
+			triangle = static_cast<std::uint32_t>(i);
+			found = true;
+		}
+	}
+	return found;
+}
+
+
+/// Pick the closest lane; ties go to the lowest triangle index, as in the scalar loop.
+template <int Width>
+auto ReduceLanes(const float (&laneT)[Width], const std::uint32_t (&laneTriangle)[Width], const bool (&laneHit)[Width],
+	float& tBest, std::uint32_t& triangle) -> bool
+{
+	bool found = false;
+	for (int lane = 0; lane < Width; ++lane)
+	{
+		if (!laneHit[lane])
+			continue;
+		if (laneT[lane] < tBest || (laneT[lane] == tBest && found && laneTriangle[lane] < triangle))
+		{
+			tBest = laneT[lane];
+			triangle = laneTriangle[lane];
+			found = true;
+		}
+	}
+	return found;
+}
+
+
+MC_TARGET("sse4.1")
+auto Sse41Triangles(const MC_OpenGL::TriangleView& tri, std::size_t first, std::size_t count,
+	const glm::vec3& o, const glm::vec3& d, float& tBest, std::uint32_t& triangle) -> bool
+{
+	const std::size_t simdCount = count & ~std::size_t(3);
+
+	const __m128 ox = _mm_set1_ps(o.x);
+	const __m128 oy = _mm_set1_ps(o.y);
+	const __m128 oz = _mm_set1_ps(o.z);
+	const __m128 dx = _mm_set1_ps(d.x);
+	const __m128 dy = _mm_set1_ps(d.y);
+	const __m128 dz = _mm_set1_ps(d.z);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+
+	__m128 bestT = _mm_set1_ps(tBest);
+	__m128i bestIndex = _mm_setzero_si128();
+	__m128 anyHit = _mm_setzero_ps();
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	index = _mm_add_epi32(index, _mm_set1_epi32(static_cast<int>(first)));
+
+	for (std::size_t i = first; i < first + simdCount; i += 4)
+	{
+		const __m128 x0 = _mm_loadu_ps(&tri.coords[0][i]);
+		const __m128 y0 = _mm_loadu_ps(&tri.coords[1][i]);
+		const __m128 z0 = _mm_loadu_ps(&tri.coords[2][i]);
+
+		const __m128 e1x = _mm_sub_ps(_mm_loadu_ps(&tri.coords[3][i]), x0);
+		const __m128 e1y = _mm_sub_ps(_mm_loadu_ps(&tri.coords[4][i]), y0);
+		const __m128 e1z = _mm_sub_ps(_mm_loadu_ps(&tri.coords[5][i]), z0);
+		const __m128 e2x = _mm_sub_ps(_mm_loadu_ps(&tri.coords[6][i]), x0);
+		const __m128 e2y = _mm_sub_ps(_mm_loadu_ps(&tri.coords[7][i]), y0);
+		const __m128 e2z = _mm_sub_ps(_mm_loadu_ps(&tri.coords[8][i]), z0);
+
+		const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+		const __m128 sx = _mm_sub_ps(ox, x0);
+		const __m128 sy = _mm_sub_ps(oy, y0);
+		const __m128 sz = _mm_sub_ps(oz, z0);
+
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+		const __m128 invDet = _mm_div_ps(one, det);
+		const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+		const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+		const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+		__m128 hit = _mm_cmpneq_ps(det, zero);
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t, bestT));
+
+		bestT = _mm_blendv_ps(bestT, t, hit);
+		bestIndex = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(bestIndex), _mm_castsi128_ps(index), hit));
+		anyHit = _mm_or_ps(anyHit, hit);
+		index = _mm_add_epi32(index, _mm_set1_epi32(4));
+	}
+
+	float laneT[4];
+	std::uint32_t laneTriangle[4];
+	_mm_storeu_ps(laneT, bestT);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(laneTriangle), bestIndex);
+
+	const int mask = _mm_movemask_ps(anyHit);
+	bool laneHit[4];
+	for (int lane = 0; lane < 4; ++lane)
+		laneHit[lane] = (mask & (1 << lane)) != 0;
+
+	bool found = ReduceLanes<4>(laneT, laneTriangle, laneHit, tBest, triangle);
+	if (ScalarTriangles(tri, first + simdCount, count - simdCount, o, d, tBest, triangle))
+		found = true;
+	return found;
+}
+
+
+MC_TARGET("avx2")
+auto Avx2Triangles(const MC_OpenGL::TriangleView& tri, std::size_t first, std::size_t count,
+	const glm::vec3& o, const glm::vec3& d, float& tBest, std::uint32_t& triangle) -> bool
+{
+	const std::size_t simdCount = count & ~std::size_t(7);
+
+	const __m256 ox = _mm256_set1_ps(o.x);
+	const __m256 oy = _mm256_set1_ps(o.y);
+	const __m256 oz = _mm256_set1_ps(o.z);
+	const __m256 dx = _mm256_set1_ps(d.x);
+	const __m256 dy = _mm256_set1_ps(d.y);
+	const __m256 dz = _mm256_set1_ps(d.z);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.f);
+
+	__m256 bestT = _mm256_set1_ps(tBest);
+	__m256i bestIndex = _mm256_setzero_si256();
+	__m256 anyHit = _mm256_setzero_ps();
+	__m256i index = _mm256_add_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(first)));
+
+	for (std::size_t i = first; i < first + simdCount; i += 8)
+	{
+		const __m256 x0 = _mm256_loadu_ps(&tri.coords[0][i]);
+		const __m256 y0 = _mm256_loadu_ps(&tri.coords[1][i]);
+		const __m256 z0 = _mm256_loadu_ps(&tri.coords[2][i]);
+
+		const __m256 e1x = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[3][i]), x0);
+		const __m256 e1y = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[4][i]), y0);
+		const __m256 e1z = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[5][i]), z0);
+		const __m256 e2x = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[6][i]), x0);
+		const __m256 e2y = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[7][i]), y0);
+		const __m256 e2z = _mm256_sub_ps(_mm256_loadu_ps(&tri.coords[8][i]), z0);
+
+		const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+		const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+		const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+		const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+
+		const __m256 sx = _mm256_sub_ps(ox, x0);
+		const __m256 sy = _mm256_sub_ps(oy, y0);
+		const __m256 sz = _mm256_sub_ps(oz, z0);
+
+		const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+		const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+		const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+
+		const __m256 invDet = _mm256_div_ps(one, det);
+		const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), invDet);
+		const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), invDet);
+		const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), invDet);
+
+		__m256 hit = _mm256_cmp_ps(det, zero, _CMP_NEQ_UQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, bestT, _CMP_LT_OQ));
+
+		bestT = _mm256_blendv_ps(bestT, t, hit);
+		bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), hit));
+		anyHit = _mm256_or_ps(anyHit, hit);
+		index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+	}
+
+	float laneT[8];
+	std::uint32_t laneTriangle[8];
+	_mm256_storeu_ps(laneT, bestT);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(laneTriangle), bestIndex);
+
+	const int mask = _mm256_movemask_ps(anyHit);
+	bool laneHit[8];
+	for (int lane = 0; lane < 8; ++lane)
+		laneHit[lane] = (mask & (1 << lane)) != 0;
+
+	bool found = ReduceLanes<8>(laneT, laneTriangle, laneHit, tBest, triangle);
+	if (ScalarTriangles(tri, first + simdCount, count - simdCount, o, d, tBest, triangle))
+		found = true;
+	return found;
+}
+
+
+MC_TARGET("avx512f")
+auto Avx512Triangles(const MC_OpenGL::TriangleView& tri, std::size_t first, std::size_t count,
+	const glm::vec3& o, const glm::vec3& d, float& tBest, std::uint32_t& triangle) -> bool
+{
+	const std::size_t simdCount = count & ~std::size_t(15);
+
+	const __m512 ox = _mm512_set1_ps(o.x);
+	const __m512 oy = _mm512_set1_ps(o.y);
+	const __m512 oz = _mm512_set1_ps(o.z);
+	const __m512 dx = _mm512_set1_ps(d.x);
+	const __m512 dy = _mm512_set1_ps(d.y);
+	const __m512 dz = _mm512_set1_ps(d.z);
+	const __m512 zero = _mm512_setzero_ps();
+	const __m512 one = _mm512_set1_ps(1.f);
+
+	__m512 bestT = _mm512_set1_ps(tBest);
+	__m512i bestIndex = _mm512_setzero_si512();
+	__mmask16 anyHit = 0;
+	__m512i index = _mm512_add_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(first)));
+
+	for (std::size_t i = first; i < first + simdCount; i += 16)
+	{
+		const __m512 x0 = _mm512_loadu_ps(&tri.coords[0][i]);
+		const __m512 y0 = _mm512_loadu_ps(&tri.coords[1][i]);
+		const __m512 z0 = _mm512_loadu_ps(&tri.coords[2][i]);
+
+		const __m512 e1x = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[3][i]), x0);
+		const __m512 e1y = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[4][i]), y0);
+		const __m512 e1z = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[5][i]), z0);
+		const __m512 e2x = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[6][i]), x0);
+		const __m512 e2y = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[7][i]), y0);
+		const __m512 e2z = _mm512_sub_ps(_mm512_loadu_ps(&tri.coords[8][i]), z0);
+
+		const __m512 px = _mm512_sub_ps(_mm512_mul_ps(dy, e2z), _mm512_mul_ps(dz, e2y));
+		const __m512 py = _mm512_sub_ps(_mm512_mul_ps(dz, e2x), _mm512_mul_ps(dx, e2z));
+		const __m512 pz = _mm512_sub_ps(_mm512_mul_ps(dx, e2y), _mm512_mul_ps(dy, e2x));
+		const __m512 det = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e1x, px), _mm512_mul_ps(e1y, py)), _mm512_mul_ps(e1z, pz));
+
+		const __m512 sx = _mm512_sub_ps(ox, x0);
+		const __m512 sy = _mm512_sub_ps(oy, y0);
+		const __m512 sz = _mm512_sub_ps(oz, z0);
+
+		const __m512 qx = _mm512_sub_ps(_mm512_mul_ps(sy, e1z), _mm512_mul_ps(sz, e1y));
+		const __m512 qy = _mm512_sub_ps(_mm512_mul_ps(sz, e1x), _mm512_mul_ps(sx, e1z));
+		const __m512 qz = _mm512_sub_ps(_mm512_mul_ps(sx, e1y), _mm512_mul_ps(sy, e1x));
+
+		const __m512 invDet = _mm512_div_ps(one, det);
+		const __m512 u = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(sx, px), _mm512_mul_ps(sy, py)), _mm512_mul_ps(sz, pz)), invDet);
+		const __m512 v = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, qx), _mm512_mul_ps(dy, qy)), _mm512_mul_ps(dz, qz)), invDet);
+		const __m512 t = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e2x, qx), _mm512_mul_ps(e2y, qy)), _mm512_mul_ps(e2z, qz)), invDet);
+
+		__mmask16 hit = _mm512_cmp_ps_mask(det, zero, _CMP_NEQ_UQ);
+		hit &= _mm512_cmp_ps_mask(u, zero, _CMP_GE_OQ);
+		hit &= _mm512_cmp_ps_mask(v, zero, _CMP_GE_OQ);
+		hit &= _mm512_cmp_ps_mask(_mm512_add_ps(u, v), one, _CMP_LE_OQ);
+		hit &= _mm512_cmp_ps_mask(t, zero, _CMP_GE_OQ);
+		hit &= _mm512_cmp_ps_mask(t, bestT, _CMP_LT_OQ);
+
+		bestT = _mm512_mask_blend_ps(hit, bestT, t);
+		bestIndex = _mm512_mask_blend_epi32(hit, bestIndex, index);
+		anyHit |= hit;
+		index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+	}
+
+	float laneT[16];
+	std::uint32_t laneTriangle[16];
+	_mm512_storeu_ps(laneT, bestT);
+	_mm512_storeu_si512(laneTriangle, bestIndex);
+
+	bool laneHit[16];
+	for (int lane = 0; lane < 16; ++lane)
+		laneHit[lane] = (anyHit & (1 << lane)) != 0;
+
+	bool found = ReduceLanes<16>(laneT, laneTriangle, laneHit, tBest, triangle);
+	if (ScalarTriangles(tri, first + simdCount, count - simdCount, o, d, tBest, triangle))
+		found = true;
+	return found;
+}
+
+
+using TrianglesKernel = bool (*)(const MC_OpenGL::TriangleView&, std::size_t, std::size_t, const glm::vec3&, const glm::vec3&, float&, std::uint32_t&);
+
+
+std::atomic<MC_OpenGL::SimdLevel> simdLevel = MC_OpenGL::DetectSimdLevel();
+
+
+}
+
+
+auto MC_OpenGL::DetectSimdLevel() -> SimdLevel
+{
+	unsigned int regs[4];
+	Cpuid(0, 0, regs);
+	const unsigned int maxLeaf = regs[0];
+	if (maxLeaf < 1)
+		return SimdLevel::Scalar;
+
+	Cpuid(1, 0, regs);
+	const bool sse41 = (regs[2] & (1u << 19)) != 0;
+	const bool osxsave = (regs[2] & (1u << 27)) != 0;
+	const bool avx = (regs[2] & (1u << 28)) != 0;
+	if (!sse41)
+		return SimdLevel::Scalar;
+	if (!osxsave || !avx || maxLeaf < 7)
+		return SimdLevel::Sse41;
+
+	// The OS has to save the YMM (and for AVX-512 the opmask and ZMM) registers on context switches.
+	const unsigned long long xcr0 = Xgetbv();
+	if ((xcr0 & 0x6) != 0x6)
+		return SimdLevel::Sse41;
+
+	Cpuid(7, 0, regs);
+	const bool avx2 = (regs[1] & (1u << 5)) != 0;
+	const bool avx512f = (regs[1] & (1u << 16)) != 0;
+	if (!avx2)
+		return SimdLevel::Sse41;
+	if (avx512f && (xcr0 & 0xE6) == 0xE6)
+		return SimdLevel::Avx512;
+	return SimdLevel::Avx2;
+}
+
+
+auto MC_OpenGL::GetSimdLevel() -> SimdLevel
+{
+	return simdLevel.load(std::memory_order_relaxed);
+}
+
+
+auto MC_OpenGL::SetSimdLevel(SimdLevel level) -> void
+{
+	simdLevel.store(std::min(level, DetectSimdLevel()), std::memory_order_relaxed);
+}
+
+
+auto MC_OpenGL::IntersectRayTriangles(const TriangleView& triangles, std::size_t first, std::size_t count,
+	const glm::vec3& origin, const glm::vec3& direction, float& tBest, std::uint32_t& triangle) -> bool
+{
+	TrianglesKernel kernel = ScalarTriangles;
+	switch (GetSimdLevel())
+	{
+	case SimdLevel::Avx512:
+		kernel = Avx512Triangles;
+		break;
+	case SimdLevel::Avx2:
+		kernel = Avx2Triangles;
+		break;
+	case SimdLevel::Sse41:
+		kernel = Sse41Triangles;
+		break;
+	default:
+		break;
+	}
+	return kernel(triangles, first, count, origin, direction, tBest, triangle);
+}
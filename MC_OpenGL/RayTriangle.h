@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm.hpp>
+
+#include "TriangleStore.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	enum class SimdLevel
+	{
+		Scalar,
+		Sse41,
+		Avx2,
+		Avx512
+	};
+
+
+	/// <summary> The widest instruction set supported by both the CPU and the OS. </summary>
+	auto DetectSimdLevel() -> SimdLevel;
+
+	/// <summary> The instruction set the ray-triangle kernels currently dispatch to. Defaults to
+	/// 		  DetectSimdLevel(); SetSimdLevel can force a narrower one, e.g. to compare results. </summary>
+	auto GetSimdLevel() -> SimdLevel;
+	auto SetSimdLevel(SimdLevel level) -> void;
+
+	/// <summary> Intersect one ray with the triangles [first, first + count) of a view using Möller-Trumbore.
+	/// 		  Every SIMD level gives bit-identical results to the scalar kernel. </summary>
+	///
+	/// <param name="tBest">    [in,out] Only hits closer than this are reported; updated with the closest hit. </param>
+	/// <param name="triangle"> [out] Index of the closest triangle when a hit is reported. </param>
+	///
+	/// <returns> True if a triangle closer than the incoming tBest was hit. </returns>
+	auto IntersectRayTriangles(const TriangleView& triangles, std::size_t first, std::size_t count,
+		const glm::vec3& origin, const glm::vec3& direction, float& tBest, std::uint32_t& triangle) -> bool;
+
+
+}
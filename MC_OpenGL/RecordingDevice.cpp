@@ -0,0 +1,251 @@
+#include "RecordingDevice.h"
+
+#include <gtc/type_ptr.hpp>
+
+
+auto MC_OpenGL::RecordingDevice::ActiveTexture(GLuint unit) -> void
+{
+	RecordStateChange(DeviceOp::ActiveTexture, unit);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BindBuffer(GLenum target, GLuint buffer) -> void
+{
+	RecordStateChange(DeviceOp::BindBuffer, target, buffer);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BindBufferBase(GLenum target, GLuint index, GLuint buffer) -> void
+{
+	RecordStateChange(DeviceOp::BindBufferBase, target, index, buffer);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BindSampler(GLuint unit, GLuint sampler) -> void
+{
+	RecordStateChange(DeviceOp::BindSampler, unit, sampler);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BindTexture(GLuint texture) -> void
+{
+	RecordStateChange(DeviceOp::BindTexture, texture);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BindVertexArray(GLuint vao) -> void
+{
+	RecordStateChange(DeviceOp::BindVertexArray, vao);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void
+{
+	Record(DeviceOp::BufferData, target, size, usage);
+	if (data != nullptr)
+		m_Stats.bytesUploaded += static_cast<std::size_t>(size);
+}
+
+
+auto MC_OpenGL::RecordingDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void
+{
+	Record(DeviceOp::BufferSubData, target, offset, size);
+	if (data != nullptr)
+		m_Stats.bytesUploaded += static_cast<std::size_t>(size);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Clear(GLbitfield mask) -> void
+{
+	Record(DeviceOp::Clear, mask);
+}
+
+
+auto MC_OpenGL::RecordingDevice::ClearColor(float r, float g, float b, float a) -> void
+{
+	RecordStateChange(DeviceOp::ClearColor, static_cast<std::int64_t>(m_Values.size()));
+	m_Values.insert(m_Values.end(), { r, g, b, a });
+}
+
+
+auto MC_OpenGL::RecordingDevice::Commands() const -> const std::vector<DeviceCommand>&
+{
+	return m_Commands;
+}
+
+
+auto MC_OpenGL::RecordingDevice::CreateBuffer() -> GLuint
+{
+	const GLuint buffer = m_NextName++;
+	Record(DeviceOp::CreateBuffer, buffer);
+	return buffer;
+}
+
+
+auto MC_OpenGL::RecordingDevice::CreateVertexArray() -> GLuint
+{
+	const GLuint vao = m_NextName++;
+	Record(DeviceOp::CreateVertexArray, vao);
+	return vao;
+}
+
+
+auto MC_OpenGL::RecordingDevice::DeleteBuffer(GLuint buffer) -> void
+{
+	if (buffer != 0)
+		Record(DeviceOp::DeleteBuffer, buffer);
+}
+
+
+auto MC_OpenGL::RecordingDevice::DeleteTexture(GLuint texture) -> void
+{
+	if (texture != 0)
+		Record(DeviceOp::DeleteTexture, texture);
+}
+
+
+auto MC_OpenGL::RecordingDevice::DeleteVertexArray(GLuint vao) -> void
+{
+	if (vao != 0)
+		Record(DeviceOp::DeleteVertexArray, vao);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Disable(GLenum capability) -> void
+{
+	RecordStateChange(DeviceOp::Disable, capability);
+}
+
+
+auto MC_OpenGL::RecordingDevice::DrawArrays(GLenum mode, GLint first, GLsizei count) -> void
+{
+	Record(DeviceOp::DrawArrays, mode, first, count);
+	++m_Stats.draws;
+	m_Stats.vertices += static_cast<std::size_t>(count);
+}
+
+
+auto MC_OpenGL::RecordingDevice::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void
+{
+	Record(DeviceOp::DrawArraysInstanced, mode, first, count, instances);
+	++m_Stats.draws;
+	m_Stats.vertices += static_cast<std::size_t>(count) * static_cast<std::size_t>(instances);
+}
+
+
+auto MC_OpenGL::RecordingDevice::DrawElements(GLenum mode, GLsizei count, GLenum type, std::size_t offset) -> void
+{
+	Record(DeviceOp::DrawElements, mode, count, type, static_cast<std::int64_t>(offset));
+	++m_Stats.draws;
+	m_Stats.vertices += static_cast<std::size_t>(count);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Enable(GLenum capability) -> void
+{
+	RecordStateChange(DeviceOp::Enable, capability);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Record(DeviceOp op, std::int64_t a, std::int64_t b, std::int64_t c, std::int64_t d, std::int64_t e) -> void
+{
+	m_Commands.push_back({ op, { a, b, c, d, e } });
+	++m_Stats.commands;
+}
+
+
+auto MC_OpenGL::RecordingDevice::RecordStateChange(DeviceOp op, std::int64_t a, std::int64_t b, std::int64_t c, std::int64_t d) -> void
+{
+	Record(op, a, b, c, d);
+	++m_Stats.stateChanges;
+}
+
+
+template <typename T>
+auto MC_OpenGL::RecordingDevice::RecordUniform(GLint location, const T* values, std::int64_t components) -> void
+{
+	Record(DeviceOp::SetUniform, location, components, static_cast<std::int64_t>(m_Values.size()));
+	m_Values.insert(m_Values.end(), values, values + components);
+	++m_Stats.uniformSets;
+}
+
+
+auto MC_OpenGL::RecordingDevice::Report(std::ostream& os) const -> void
+{
+	os << "Recorded: " << m_Stats.commands << " commands, " << m_Stats.draws << " draws of " << m_Stats.vertices << " vertices, "
+		<< m_Stats.stateChanges << " state changes, " << m_Stats.uniformSets << " uniform sets, " << m_Stats.bytesUploaded << " bytes uploaded\n";
+}
+
+
+auto MC_OpenGL::RecordingDevice::Reset() -> void
+{
+	m_Commands.clear();
+	m_Values.clear();
+	m_Stats = RecordingStats();
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, float value) -> void
+{
+	RecordUniform(location, &value, 1);
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, int value) -> void
+{
+	RecordUniform(location, &value, 1);
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, GLuint value) -> void
+{
+	RecordUniform(location, &value, 1);
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, const glm::vec3& value) -> void
+{
+	RecordUniform(location, glm::value_ptr(value), 3);
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, const glm::vec4& value) -> void
+{
+	RecordUniform(location, glm::value_ptr(value), 4);
+}
+
+
+auto MC_OpenGL::RecordingDevice::SetUniform(GLint location, const glm::mat4& value) -> void
+{
+	RecordUniform(location, glm::value_ptr(value), 16);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Stats() const -> const RecordingStats&
+{
+	return m_Stats;
+}
+
+
+auto MC_OpenGL::RecordingDevice::UseProgram(GLuint program) -> void
+{
+	RecordStateChange(DeviceOp::UseProgram, program);
+}
+
+
+auto MC_OpenGL::RecordingDevice::VertexAttribute(GLuint index, GLint size, GLsizei stride, std::size_t offset, GLuint divisor) -> void
+{
+	Record(DeviceOp::VertexAttribute, index, size, stride, static_cast<std::int64_t>(offset), divisor);
+}
+
+
+auto MC_OpenGL::RecordingDevice::Values() const -> const std::vector<double>&
+{
+	return m_Values;
+}
+
+
+auto MC_OpenGL::RecordingDevice::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void
+{
+	RecordStateChange(DeviceOp::Viewport, x, y, width, height);
+}
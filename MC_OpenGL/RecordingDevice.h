@@ -0,0 +1,130 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "RenderDevice.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	enum class DeviceOp : std::uint8_t
+	{
+		ActiveTexture,
+		BindBuffer,
+		BindBufferBase,
+		BindSampler,
+		BindTexture,
+		BindVertexArray,
+		BufferData,
+		BufferSubData,
+		Clear,
+		ClearColor,
+		CreateBuffer,
+		CreateVertexArray,
+		DeleteBuffer,
+		DeleteTexture,
+		DeleteVertexArray,
+		Disable,
+		DrawArrays,
+		DrawArraysInstanced,
+		DrawElements,
+		Enable,
+		SetUniform,
+		UseProgram,
+		VertexAttribute,
+		Viewport
+	};
+
+
+	/// <summary> One recorded call. args holds its integer arguments in the order the RenderDevice method
+	/// 		  takes them, and the name it returned for the Create calls. Other values go to
+	/// 		  RecordingDevice::Values and args says where they start: ClearColor is { first }, red to
+	/// 		  alpha from there, and SetUniform is { location, components, first }. Integer uniforms go
+	/// 		  there too; a double holds them exactly. </summary>
+	struct DeviceCommand
+	{
+		DeviceOp						op		= DeviceOp::Clear;
+		std::array<std::int64_t, 5>		args	= {};
+	};
+
+
+	struct RecordingStats
+	{
+		std::size_t		commands		= 0;
+		std::size_t		draws			= 0;
+		std::size_t		vertices		= 0;	// Vertices or indices drawn, times the instances.
+		std::size_t		stateChanges	= 0;	// Binds, the program, enables and the viewport.
+		std::size_t		uniformSets		= 0;
+		std::size_t		bytesUploaded	= 0;
+	};
+
+
+	/// <summary> Keeps the calls in memory instead of making them, so that the CPU side of a frame can be
+	/// 		  timed and checked on machines without a GPU. Create calls hand out names counting up from 1,
+	/// 		  which are never reused. Install it with SetDevice; drawables need a ready Shader, which can
+	/// 		  wrap a made up program id and uniform table. </summary>
+	class RecordingDevice : public RenderDevice
+	{
+	public:
+		auto ActiveTexture(GLuint unit) -> void override;
+		auto BindBuffer(GLenum target, GLuint buffer) -> void override;
+		auto BindBufferBase(GLenum target, GLuint index, GLuint buffer) -> void override;
+		auto BindSampler(GLuint unit, GLuint sampler) -> void override;
+		auto BindTexture(GLuint texture) -> void override;
+		auto BindVertexArray(GLuint vao) -> void override;
+		auto BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void override;
+		auto BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void override;
+		auto Clear(GLbitfield mask) -> void override;
+		auto ClearColor(float r, float g, float b, float a) -> void override;
+		auto Commands() const -> const std::vector<DeviceCommand>&;
+		auto CreateBuffer() -> GLuint override;
+		auto CreateVertexArray() -> GLuint override;
+		auto DeleteBuffer(GLuint buffer) -> void override;
+		auto DeleteTexture(GLuint texture) -> void override;
+		auto DeleteVertexArray(GLuint vao) -> void override;
+		auto Disable(GLenum capability) -> void override;
+		auto DrawArrays(GLenum mode, GLint first, GLsizei count) -> void override;
+		auto DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void override;
+		auto DrawElements(GLenum mode, GLsizei count, GLenum type, std::size_t offset) -> void override;
+		auto Enable(GLenum capability) -> void override;
+		auto Report(std::ostream& os) const -> void;
+
+		/// <summary> Drop the commands and stats recorded so far, for instance at the start of a frame. Names
+		/// 		  keep counting, so objects created earlier stay distinct. </summary>
+		auto Reset() -> void;
+		auto SetUniform(GLint location, float value) -> void override;
+		auto SetUniform(GLint location, int value) -> void override;
+		auto SetUniform(GLint location, GLuint value) -> void override;
+		auto SetUniform(GLint location, const glm::vec3& value) -> void override;
+		auto SetUniform(GLint location, const glm::vec4& value) -> void override;
+		auto SetUniform(GLint location, const glm::mat4& value) -> void override;
+		auto Stats() const -> const RecordingStats&;
+		auto UseProgram(GLuint program) -> void override;
+
+		/// <summary> The values of the ClearColor and SetUniform commands, see DeviceCommand. </summary>
+		auto Values() const -> const std::vector<double>&;
+		auto VertexAttribute(GLuint index, GLint size, GLsizei stride, std::size_t offset, GLuint divisor = 0) -> void override;
+		auto Viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void override;
+
+	private:
+		auto Record(DeviceOp op, std::int64_t a = 0, std::int64_t b = 0, std::int64_t c = 0, std::int64_t d = 0, std::int64_t e = 0) -> void;
+		auto RecordStateChange(DeviceOp op, std::int64_t a = 0, std::int64_t b = 0, std::int64_t c = 0, std::int64_t d = 0) -> void;
+
+		template <typename T>
+		auto RecordUniform(GLint location, const T* values, std::int64_t components) -> void;
+
+		std::vector<DeviceCommand>	m_Commands;
+		std::vector<double>			m_Values;
+		RecordingStats				m_Stats;
+		GLuint						m_NextName	= 1;
+	};
+
+
+}
@@ -0,0 +1,27 @@
+#include "RenderDevice.h"
+
+#include "GLDevice.h"
+#include "GLState.h"
+
+
+namespace {
+
+
+MC_OpenGL::RenderDevice* current = nullptr;
+
+
+}
+
+
+auto MC_OpenGL::Device() -> RenderDevice&
+{
+	static GLDevice gl;
+	return current != nullptr ? *current : gl;
+}
+
+
+auto MC_OpenGL::SetDevice(RenderDevice* device) -> void
+{
+	current = device;
+	GLState().Invalidate();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> The GL calls rendering makes, behind one interface so that a frame can be sent to the driver
+	/// 		  or recorded without a context. Covers buffers, vertex arrays, the program in use and its
+	/// 		  uniforms, textures, fixed function state and draws. Building programs, framebuffers and texture
+	/// 		  streaming still talk to GL directly. </summary>
+	class RenderDevice
+	{
+	public:
+		RenderDevice() = default;
+		RenderDevice(const RenderDevice&) = delete;
+		auto operator=(const RenderDevice&) -> RenderDevice& = delete;
+		virtual ~RenderDevice() = default;
+
+		virtual auto ActiveTexture(GLuint unit) -> void = 0;
+		virtual auto BindBuffer(GLenum target, GLuint buffer) -> void = 0;
+		virtual auto BindBufferBase(GLenum target, GLuint index, GLuint buffer) -> void = 0;
+		virtual auto BindSampler(GLuint unit, GLuint sampler) -> void = 0;
+
+		/// <summary> Bind texture to GL_TEXTURE_2D of the active unit. </summary>
+		virtual auto BindTexture(GLuint texture) -> void = 0;
+		virtual auto BindVertexArray(GLuint vao) -> void = 0;
+
+		/// <summary> Allocate size bytes for the buffer bound to target, initialized from data unless it is
+		/// 		  null. </summary>
+		virtual auto BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void = 0;
+		virtual auto BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void = 0;
+		virtual auto Clear(GLbitfield mask) -> void = 0;
+		virtual auto ClearColor(float r, float g, float b, float a) -> void = 0;
+		virtual auto CreateBuffer() -> GLuint = 0;
+		virtual auto CreateVertexArray() -> GLuint = 0;
+
+		/// <summary> Deleting 0 does nothing. </summary>
+		virtual auto DeleteBuffer(GLuint buffer) -> void = 0;
+		virtual auto DeleteTexture(GLuint texture) -> void = 0;
+		virtual auto DeleteVertexArray(GLuint vao) -> void = 0;
+		virtual auto Disable(GLenum capability) -> void = 0;
+		virtual auto DrawArrays(GLenum mode, GLint first, GLsizei count) -> void = 0;
+		virtual auto DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void = 0;
+
+		/// <summary> offset is in bytes into the element array buffer of the bound vertex array. </summary>
+		virtual auto DrawElements(GLenum mode, GLsizei count, GLenum type, std::size_t offset) -> void = 0;
+		virtual auto Enable(GLenum capability) -> void = 0;
+		virtual auto SetUniform(GLint location, float value) -> void = 0;
+		virtual auto SetUniform(GLint location, int value) -> void = 0;
+		virtual auto SetUniform(GLint location, GLuint value) -> void = 0;
+		virtual auto SetUniform(GLint location, const glm::vec3& value) -> void = 0;
+		virtual auto SetUniform(GLint location, const glm::vec4& value) -> void = 0;
+		virtual auto SetUniform(GLint location, const glm::mat4& value) -> void = 0;
+		virtual auto UseProgram(GLuint program) -> void = 0;
+
+		/// <summary> Source the float attribute index of the bound vertex array from the buffer bound to
+		/// 		  GL_ARRAY_BUFFER and enable it. A nonzero divisor advances it per that many instances
+		/// 		  rather than per vertex. </summary>
+		virtual auto VertexAttribute(GLuint index, GLint size, GLsizei stride, std::size_t offset, GLuint divisor = 0) -> void = 0;
+		virtual auto Viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void = 0;
+	};
+
+
+	/// <summary> The device rendering goes to: the one set by SetDevice, or GL when none is. </summary>
+	auto Device() -> RenderDevice&;
+
+	/// <summary> Send rendering to device from now on, or back to GL for nullptr. The GL state cache is
+	/// 		  invalidated, since what it remembers was set on the previous device. </summary>
+	auto SetDevice(RenderDevice* device) -> void;
+
+
+}
@@ -0,0 +1,125 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "Drawable.h"
+#include "Profiler.h"
+
+
+namespace {
+
+
+constexpr int			passShift		= 62;
+constexpr int			programShift	= 48;
+constexpr int			materialShift	= 32;
+constexpr int			vaoShift		= 20;
+constexpr std::uint64_t	programMask		= (1ull << 14) - 1;
+constexpr std::uint64_t	materialMask	= (1ull << 16) - 1;
+constexpr std::uint64_t	vaoMask			= (1ull << 12) - 1;
+
+
+// The bits of a non-negative float order like the float, so the top 20 of them give a depth with a
+// relative precision of 1/4096 over the whole range.
+auto QuantizeDepth(float depth) -> std::uint64_t
+{
+	depth = std::max(depth, 0.f);
+	std::uint32_t bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+	return bits >> 11;
+}
+
+
+}
+
+
+auto MC_OpenGL::RenderQueue::Add(RenderPass pass, const Drawable* drawable, const glm::vec3& color, float depth) -> void
+{
+	m_Items.push_back({ MakeKey(pass, drawable->GetShaderId(), drawable->GetMaterial(), drawable->GetVao(), depth), drawable, color });
+}
+
+
+auto MC_OpenGL::RenderQueue::Clear() -> void
+{
+	m_Items.clear();
+	m_Stats = RenderQueueStats();
+}
+
+
+auto MC_OpenGL::RenderQueue::Items() const -> const std::vector<RenderItem>&
+{
+	return m_Items;
+}
+
+
+auto MC_OpenGL::RenderQueue::MakeKey(RenderPass pass, GLuint program, GLuint material, GLuint vao, float depth) -> std::uint64_t
+{
+	return (static_cast<std::uint64_t>(pass) << passShift) | ((program & programMask) << programShift)
+		| ((material & materialMask) << materialShift) | ((vao & vaoMask) << vaoShift) | QuantizeDepth(depth);
+}
+
+
+auto MC_OpenGL::RenderQueue::Size() const -> std::size_t
+{
+	return m_Items.size();
+}
+
+
+auto MC_OpenGL::RenderQueue::Sort() -> void
+{
+	MC_PROFILE_ZONE("RenderQueue::Sort");
+	m_Scratch.resize(m_Items.size());
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		std::array<std::size_t, 256> counts = {};
+		for (const RenderItem& item : m_Items)
+			++counts[(item.key >> shift) & 0xFF];
+
+		// Every key has the same digit here; the pass would not move anything.
+		if (std::find(counts.begin(), counts.end(), m_Items.size()) != counts.end())
+			continue;
+
+		std::size_t offset = 0;
+		for (std::size_t& count : counts)
+		{
+			const std::size_t digitCount = count;
+			count = offset;
+			offset += digitCount;
+		}
+		for (const RenderItem& item : m_Items)
+			m_Scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+		m_Items.swap(m_Scratch);
+	}
+}
+
+
+auto MC_OpenGL::RenderQueue::Stats() const -> const RenderQueueStats&
+{
+	return m_Stats;
+}
+
+
+auto MC_OpenGL::RenderQueue::Submit(RenderPass pass, const DrawFn& fn) -> void
+{
+	MC_PROFILE_ZONE("RenderQueue::Submit");
+	// Items of one pass are contiguous once sorted.
+	const std::uint64_t first = static_cast<std::uint64_t>(pass) << passShift;
+	auto begin = std::lower_bound(m_Items.begin(), m_Items.end(), first, [](const RenderItem& item, std::uint64_t key) { return item.key < key; });
+	auto end = begin;
+	while (end != m_Items.end() && (end->key >> passShift) == static_cast<std::uint64_t>(pass))
+		++end;
+
+	for (auto item = begin; item != end; ++item)
+	{
+		if (item != begin)
+		{
+			const std::uint64_t changed = item->key ^ (item - 1)->key;
+			m_Stats.programChanges += ((changed >> programShift) & programMask) != 0;
+			m_Stats.materialChanges += ((changed >> materialShift) & materialMask) != 0;
+			m_Stats.vaoChanges += ((changed >> vaoShift) & vaoMask) != 0;
+		}
+		fn(*item);
+	}
+	m_Stats.items += end - begin;
+}
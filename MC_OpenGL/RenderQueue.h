@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+
+namespace MC_OpenGL
+{
+
+
+	class Drawable;
+
+
+	/// <summary> Passes are submitted in this order. </summary>
+	enum class RenderPass : std::uint8_t
+	{
+		Opaque,
+		Highlight	// Hovered and selected drawables, drawn over the opaque pass.
+	};
+
+
+	struct RenderItem
+	{
+		std::uint64_t		key			= 0;
+		const Drawable*		drawable	= nullptr;
+		glm::vec3			color		= glm::vec3(0.f);
+	};
+
+
+	/// <summary> Items submitted since the last Clear and the state changes between consecutive ones. </summary>
+	struct RenderQueueStats
+	{
+		std::size_t		items			= 0;
+		std::size_t		programChanges	= 0;
+		std::size_t		materialChanges	= 0;
+		std::size_t		vaoChanges		= 0;
+	};
+
+
+	/// <summary> Collects a frame's draws and submits them sorted by a packed key, so that drawables sharing
+	/// 		  a program, material and vertex array are drawn back to back, nearer ones first. From the most
+	/// 		  significant bit the key holds the pass (2 bits), the program (14), the material (16), the vertex
+	/// 		  array (12) and the view depth (20). GL names are truncated to their field; names that collide
+	/// 		  only cost an extra state change, never a wrong draw. </summary>
+	class RenderQueue
+	{
+	public:
+		using DrawFn = std::function<void(const RenderItem& item)>;
+
+		RenderQueue() = default;
+		RenderQueue(const RenderQueue&) = delete;
+		auto operator=(const RenderQueue&) -> RenderQueue& = delete;
+
+		/// <summary> Queue drawable for pass. depth is its distance in front of the camera; anything behind
+		/// 		  the camera sorts first. </summary>
+		auto Add(RenderPass pass, const Drawable* drawable, const glm::vec3& color, float depth) -> void;
+		auto Clear() -> void;
+		auto Items() const -> const std::vector<RenderItem>&;
+		auto Size() const -> std::size_t;
+
+		/// <summary> Sort the items by key with an 8 bit LSD radix sort, skipping the digits all keys share.
+		/// 		  Call after the last Add and before Submit. </summary>
+		auto Sort() -> void;
+		auto Stats() const -> const RenderQueueStats&;
+
+		/// <summary> Call fn for the sorted items of pass, in order. </summary>
+		auto Submit(RenderPass pass, const DrawFn& fn) -> void;
+
+		static auto MakeKey(RenderPass pass, GLuint program, GLuint material, GLuint vao, float depth) -> std::uint64_t;
+
+	private:
+		std::vector<RenderItem>	m_Items;
+		std::vector<RenderItem>	m_Scratch;
+		RenderQueueStats		m_Stats;
+	};
+
+
+}
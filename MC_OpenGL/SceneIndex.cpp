@@ -0,0 +1,453 @@
+#include "SceneIndex.h"
+
+#include <algorithm>
+#include <array>
+
+#include "Drawable.h"
+
+
+namespace {
+
+
+auto HalfArea(const glm::vec3& min, const glm::vec3& max) -> float
+{
+	glm::vec3 e = max - min;
+	return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+
+/// Entry parameter of the ray into the box, 0 if it starts inside, or infinity when the ray misses it. Boxes
+/// behind the origin are missed, so box parameters compare directly with the triangle hits' t >= 0.
+auto IntersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& invDirection) -> float
+{
+	glm::vec3 t0 = (min - origin) * invDirection;
+	glm::vec3 t1 = (max - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+	float tExit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+	return (tEnter <= tExit) ? tEnter : std::numeric_limits<float>::infinity();
+}
+
+
+}
+
+
+auto MC_OpenGL::SceneIndex::AllocateNode() -> std::int32_t
+{
+	if (!m_FreeNodes.empty())
+	{
+		std::int32_t node = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+		m_Nodes[node] = Node();
+		return node;
+	}
+
+	m_Nodes.push_back(Node());
+	return static_cast<std::int32_t>(m_Nodes.size() - 1);
+}
+
+
+auto MC_OpenGL::SceneIndex::Build(const std::vector<Drawable*>& drawables) -> void
+{
+	Clear();
+	if (drawables.empty())
+		return;
+
+	std::vector<std::int32_t> leaves;
+	leaves.reserve(drawables.size());
+	m_Nodes.reserve(2 * drawables.size());
+	for (Drawable* drawable : drawables)
+	{
+		std::int32_t leaf = AllocateNode();
+		m_Nodes[leaf].drawable = drawable;
+		drawable->WorldBounds(m_Nodes[leaf].min, m_Nodes[leaf].max);
+		drawable->SetSceneProxy(this, leaf);
+		leaves.push_back(leaf);
+	}
+
+	m_NumLeaves = leaves.size();
+	m_Root = BuildRange(leaves, 0, leaves.size());
+}
+
+
+auto MC_OpenGL::SceneIndex::Bounds(glm::vec3& min, glm::vec3& max) const -> void
+{
+	if (m_Root == nullNode)
+	{
+		min = glm::vec3(std::numeric_limits<float>::max());
+		max = glm::vec3(std::numeric_limits<float>::lowest());
+		return;
+	}
+
+	min = m_Nodes[m_Root].min;
+	max = m_Nodes[m_Root].max;
+}
+
+
+auto MC_OpenGL::SceneIndex::BuildRange(std::vector<std::int32_t>& leaves, std::size_t first, std::size_t count) -> std::int32_t
+{
+	if (count == 1)
+		return leaves[first];
+
+	// Median split along the widest axis of the leaf centers.
+	glm::vec3 centerMin(std::numeric_limits<float>::max());
+	glm::vec3 centerMax(std::numeric_limits<float>::lowest());
+	for (std::size_t i = first; i < first + count; ++i)
+	{
+		const Node& leaf = m_Nodes[leaves[i]];
+		centerMin = glm::min(centerMin, leaf.min + leaf.max);
+		centerMax = glm::max(centerMax, leaf.min + leaf.max);
+	}
+
+	glm::vec3 extent = centerMax - centerMin;
+	int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+	const std::size_t half = count / 2;
+	auto begin = leaves.begin() + first;
+	std::nth_element(begin, begin + half, begin + count, [&](std::int32_t a, std::int32_t b)
+	{
+		return (m_Nodes[a].min[axis] + m_Nodes[a].max[axis]) < (m_Nodes[b].min[axis] + m_Nodes[b].max[axis]);
+	});
+
+	std::int32_t left = BuildRange(leaves, first, half);
+	std::int32_t right = BuildRange(leaves, first + half, count - half);
+
+	std::int32_t node = AllocateNode();
+	m_Nodes[node].left = left;
+	m_Nodes[node].right = right;
+	m_Nodes[node].min = glm::min(m_Nodes[left].min, m_Nodes[right].min);
+	m_Nodes[node].max = glm::max(m_Nodes[left].max, m_Nodes[right].max);
+	m_Nodes[left].parent = node;
+	m_Nodes[right].parent = node;
+	return node;
+}
+
+
+auto MC_OpenGL::SceneIndex::Clear() -> void
+{
+	for (const Node& node : m_Nodes)
+	{
+		if (node.drawable != nullptr)
+			node.drawable->SetSceneProxy(nullptr, nullNode);
+	}
+
+	m_Nodes.clear();
+	m_FreeNodes.clear();
+	m_Root = nullNode;
+	m_NumLeaves = 0;
+	++m_Version;
+}
+
+
+auto MC_OpenGL::SceneIndex::Extents(const glm::mat4& transform, glm::vec3& min, glm::vec3& max) const -> void
+{
+	// Repeated fits of an unchanged scene from the same view are a lookup.
+	if (m_ExtentsCache.valid && m_ExtentsCache.version == m_Version && m_ExtentsCache.transform == transform)
+	{
+		min = m_ExtentsCache.min;
+		max = m_ExtentsCache.max;
+		return;
+	}
+
+	min = glm::vec3(std::numeric_limits<float>::max());
+	max = glm::vec3(std::numeric_limits<float>::lowest());
+	if (m_Root == nullNode)
+		return;
+
+	// |M| for transforming box half extents. Assumes transform and the model matrices are affine.
+	glm::mat3 absLinear;
+	for (int col = 0; col < 3; ++col)
+	{
+		for (int row = 0; row < 3; ++row)
+			absLinear[col][row] = std::abs(transform[col][row]);
+	}
+
+	std::vector<std::int32_t> stack;
+	stack.push_back(m_Root);
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+
+		// Bound the subtree in the target space; skip it if it cannot push the extents out any further.
+		glm::vec3 center = transform * glm::vec4(0.5f * (node.min + node.max), 1.f);
+		glm::vec3 halfExtent = absLinear * (0.5f * (node.max - node.min));
+		if (glm::all(glm::greaterThanEqual(center - halfExtent, min)) && glm::all(glm::lessThanEqual(center + halfExtent, max)))
+			continue;
+
+		if (!node.IsLeaf())
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+			continue;
+		}
+
+		const glm::mat4 toTarget = transform * node.drawable->ModelMatrix();
+		for (const glm::vec3& corner : node.drawable->BoundingBox())
+		{
+			glm::vec3 pt = toTarget * glm::vec4(corner, 1.f);
+			min = glm::min(min, pt);
+			max = glm::max(max, pt);
+		}
+	}
+
+	m_ExtentsCache = ExtentsCache{ true, m_Version, transform, min, max };
+}
+
+
+auto MC_OpenGL::SceneIndex::FreeNode(std::int32_t node) -> void
+{
+	m_Nodes[node].drawable = nullptr;
+	m_FreeNodes.push_back(node);
+}
+
+
+auto MC_OpenGL::SceneIndex::Insert(Drawable* drawable) -> void
+{
+	std::int32_t leaf = AllocateNode();
+	m_Nodes[leaf].drawable = drawable;
+	drawable->WorldBounds(m_Nodes[leaf].min, m_Nodes[leaf].max);
+	drawable->SetSceneProxy(this, leaf);
+
+	InsertLeaf(leaf);
+	++m_NumLeaves;
+	++m_Version;
+}
+
+
+auto MC_OpenGL::SceneIndex::InsertLeaf(std::int32_t leaf) -> void
+{
+	if (m_Root == nullNode)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = nullNode;
+		return;
+	}
+
+	// Walk down towards the sibling that grows the total surface area the least.
+	const glm::vec3 leafMin = m_Nodes[leaf].min;
+	const glm::vec3 leafMax = m_Nodes[leaf].max;
+	std::int32_t sibling = m_Root;
+	while (!m_Nodes[sibling].IsLeaf())
+	{
+		const Node& node = m_Nodes[sibling];
+		float area = HalfArea(node.min, node.max);
+		float combinedArea = HalfArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+		// Cost of pairing the leaf with this node, and the growth every deeper choice inherits.
+		float cost = 2.f * combinedArea;
+		float inheritedCost = 2.f * (combinedArea - area);
+
+		auto ChildCost = [&](std::int32_t child) -> float
+		{
+			const Node& c = m_Nodes[child];
+			float grown = HalfArea(glm::min(c.min, leafMin), glm::max(c.max, leafMax));
+			return (c.IsLeaf() ? grown : grown - HalfArea(c.min, c.max)) + inheritedCost;
+		};
+
+		float costLeft = ChildCost(node.left);
+		float costRight = ChildCost(node.right);
+		if (cost < costLeft && cost < costRight)
+			break;
+
+		sibling = (costLeft < costRight) ? node.left : node.right;
+	}
+
+	const std::int32_t oldParent = m_Nodes[sibling].parent;
+	const std::int32_t newParent = AllocateNode();
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].left = sibling;
+	m_Nodes[newParent].right = leaf;
+	m_Nodes[newParent].min = glm::min(m_Nodes[sibling].min, leafMin);
+	m_Nodes[newParent].max = glm::max(m_Nodes[sibling].max, leafMax);
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+
+	if (oldParent == nullNode)
+		m_Root = newParent;
+	else if (m_Nodes[oldParent].left == sibling)
+		m_Nodes[oldParent].left = newParent;
+	else
+		m_Nodes[oldParent].right = newParent;
+
+	Refit(oldParent);
+}
+
+
+auto MC_OpenGL::SceneIndex::Query(const glm::vec3& min, const glm::vec3& max, const std::function<void(Drawable*)>& fn) const -> void
+{
+	if (m_Root == nullNode)
+		return;
+
+	std::vector<std::int32_t> stack;
+	stack.push_back(m_Root);
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+
+		if (glm::any(glm::lessThan(node.max, min)) || glm::any(glm::greaterThan(node.min, max)))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			fn(node.drawable);
+		}
+		else
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+
+auto MC_OpenGL::SceneIndex::Raycast(const glm::vec3& origin, const glm::vec3& direction, const HitTest& hitTest) const -> SceneHit
+{
+	SceneHit result;
+	if (m_Root == nullNode)
+		return result;
+
+	const glm::vec3 invDirection = glm::vec3(1.f) / direction;
+
+	struct Entry
+	{
+		std::int32_t	node;
+		float			parameter;
+	};
+	std::vector<Entry> stack;
+
+	float tRoot = IntersectRay(m_Nodes[m_Root].min, m_Nodes[m_Root].max, origin, invDirection);
+	if (tRoot < result.parameter)
+		stack.push_back(Entry{ m_Root, tRoot });
+
+	while (!stack.empty())
+	{
+		const Entry entry = stack.back();
+		stack.pop_back();
+
+		// A hit inside the box cannot be nearer than where the ray enters it.
+		if (entry.parameter >= result.parameter)
+			continue;
+
+		const Node& node = m_Nodes[entry.node];
+		if (node.IsLeaf())
+		{
+			float parameter = hitTest(node.drawable, entry.parameter);
+			if (parameter < result.parameter)
+			{
+				result.drawable = node.drawable;
+				result.parameter = parameter;
+			}
+			continue;
+		}
+
+		// Push the farther child first so the nearer one is visited first.
+		Entry nearChild{ node.left, IntersectRay(m_Nodes[node.left].min, m_Nodes[node.left].max, origin, invDirection) };
+		Entry farChild{ node.right, IntersectRay(m_Nodes[node.right].min, m_Nodes[node.right].max, origin, invDirection) };
+		if (farChild.parameter < nearChild.parameter)
+			std::swap(nearChild, farChild);
+
+		if (farChild.parameter < result.parameter)
+			stack.push_back(farChild);
+		if (nearChild.parameter < result.parameter)
+			stack.push_back(nearChild);
+	}
+
+	return result;
+}
+
+
+auto MC_OpenGL::SceneIndex::Refit(std::int32_t node) -> void
+{
+	while (node != nullNode)
+	{
+		Node& n = m_Nodes[node];
+		glm::vec3 min = glm::min(m_Nodes[n.left].min, m_Nodes[n.right].min);
+		glm::vec3 max = glm::max(m_Nodes[n.left].max, m_Nodes[n.right].max);
+		if (min == n.min && max == n.max)
+			return;
+
+		n.min = min;
+		n.max = max;
+		node = n.parent;
+	}
+}
+
+
+auto MC_OpenGL::SceneIndex::Remove(Drawable* drawable) -> void
+{
+	const std::int32_t leaf = drawable->GetSceneProxy();
+	if (leaf == nullNode)
+		return;
+
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	drawable->SetSceneProxy(nullptr, nullNode);
+	--m_NumLeaves;
+	++m_Version;
+}
+
+
+auto MC_OpenGL::SceneIndex::RemoveLeaf(std::int32_t leaf) -> void
+{
+	if (leaf == m_Root)
+	{
+		m_Root = nullNode;
+		return;
+	}
+
+	// The sibling takes the parent's place.
+	const std::int32_t parent = m_Nodes[leaf].parent;
+	const std::int32_t grandParent = m_Nodes[parent].parent;
+	const std::int32_t sibling = (m_Nodes[parent].left == leaf) ? m_Nodes[parent].right : m_Nodes[parent].left;
+
+	m_Nodes[sibling].parent = grandParent;
+	if (grandParent == nullNode)
+	{
+		m_Root = sibling;
+	}
+	else
+	{
+		if (m_Nodes[grandParent].left == parent)
+			m_Nodes[grandParent].left = sibling;
+		else
+			m_Nodes[grandParent].right = sibling;
+		Refit(grandParent);
+	}
+
+	FreeNode(parent);
+	m_Nodes[leaf].parent = nullNode;
+}
+
+
+auto MC_OpenGL::SceneIndex::Size() const -> std::size_t
+{
+	return m_NumLeaves;
+}
+
+
+auto MC_OpenGL::SceneIndex::Update(Drawable* drawable) -> void
+{
+	const std::int32_t leaf = drawable->GetSceneProxy();
+	if (leaf == nullNode)
+		return;
+
+	++m_Version;
+	Node& node = m_Nodes[leaf];
+	drawable->WorldBounds(node.min, node.max);
+
+	// Small moves stay inside the parent's box and only need the ancestors refit; anything else is
+	// reinserted so the tree does not degrade.
+	const std::int32_t parent = node.parent;
+	if (parent != nullNode && glm::all(glm::greaterThanEqual(node.min, m_Nodes[parent].min)) && glm::all(glm::lessThanEqual(node.max, m_Nodes[parent].max)))
+	{
+		Refit(parent);
+		return;
+	}
+
+	RemoveLeaf(leaf);
+	InsertLeaf(leaf);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <glm.hpp>
+
+
+namespace MC_OpenGL
+{
+
+
+	class Drawable;
+
+
+	struct SceneHit
+	{
+		Drawable*	drawable	= nullptr;
+		float		parameter	= std::numeric_limits<float>::infinity();	// Distance along the normalized ray direction, >= 0.
+	};
+
+
+	/// <summary> Dynamic AABB tree over the world space bounds of the drawables in a scene. Drawables that are
+	/// 		  inserted report transform changes from SetModel, and only their path to the root is updated. </summary>
+	class SceneIndex
+	{
+	public:
+		/// <summary> Called for every drawable whose world bounds the ray enters before the current best hit.
+		/// 		  boxParameter is where the ray enters those bounds, 0 when its origin is inside them. Returns
+		/// 		  the hit parameter, >= 0, or infinity for a miss. </summary>
+		using HitTest = std::function<float(Drawable* drawable, float boxParameter)>;
+
+		SceneIndex() = default;
+		SceneIndex(const SceneIndex&) = delete;
+		auto operator=(const SceneIndex&) -> SceneIndex& = delete;
+
+		/// <summary> Replace the contents with a top-down build over all drawables. Faster and better
+		/// 		  balanced than inserting them one at a time. </summary>
+		auto Build(const std::vector<Drawable*>& drawables) -> void;
+
+		/// <summary> World bounds of the whole scene, kept up to date as drawables are added, moved and
+		/// 		  removed. </summary>
+		auto Bounds(glm::vec3& min, glm::vec3& max) const -> void;
+		auto Clear() -> void;
+		auto Insert(Drawable* drawable) -> void;
+		auto Remove(Drawable* drawable) -> void;
+		auto Update(Drawable* drawable) -> void;
+
+		/// <summary> Extents of the drawables' bounding box corners after transforming them by
+		/// 		  transform * ModelMatrix(). Subtrees that cannot widen the extents are skipped. </summary>
+		auto Extents(const glm::mat4& transform, glm::vec3& min, glm::vec3& max) const -> void;
+
+		/// <summary> Call fn for every drawable whose world bounds overlap [min, max]. </summary>
+		auto Query(const glm::vec3& min, const glm::vec3& max, const std::function<void(Drawable*)>& fn) const -> void;
+
+		/// <summary> Closest hit along the ray origin + t * direction, t >= 0, nearer boxes first. </summary>
+		auto Raycast(const glm::vec3& origin, const glm::vec3& direction, const HitTest& hitTest) const -> SceneHit;
+
+		auto Size() const -> std::size_t;
+
+	private:
+		static constexpr std::int32_t nullNode = -1;
+
+		// Leaves have no children and point at their drawable.
+		struct Node
+		{
+			glm::vec3		min;
+			glm::vec3		max;
+			std::int32_t	parent		= nullNode;
+			std::int32_t	left		= nullNode;
+			std::int32_t	right		= nullNode;
+			Drawable*		drawable	= nullptr;
+
+			auto IsLeaf() const -> bool
+			{
+				return left == nullNode;
+			}
+		};
+
+		auto AllocateNode() -> std::int32_t;
+		auto BuildRange(std::vector<std::int32_t>& leaves, std::size_t first, std::size_t count) -> std::int32_t;
+		auto FreeNode(std::int32_t node) -> void;
+		auto InsertLeaf(std::int32_t leaf) -> void;
+		auto Refit(std::int32_t node) -> void;
+		auto RemoveLeaf(std::int32_t leaf) -> void;
+
+		struct ExtentsCache
+		{
+			bool			valid		= false;
+			std::uint64_t	version		= 0;
+			glm::mat4		transform	= glm::mat4(1.f);
+			glm::vec3		min			= glm::vec3(0.f);
+			glm::vec3		max			= glm::vec3(0.f);
+		};
+
+		std::vector<Node>			m_Nodes;
+		std::vector<std::int32_t>	m_FreeNodes;
+		std::int32_t				m_Root			= nullNode;
+		std::size_t					m_NumLeaves		= 0;
+
+		// Bumped by every change to the indexed bounds.
+		std::uint64_t				m_Version		= 0;
+		mutable ExtentsCache		m_ExtentsCache;
+	};
+
+
+}
@@ -3,129 +3,432 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#include <glm.hpp>
+#include <gtc/type_ptr.hpp>
 
 #include "ErrorCode.h"
+#include "FrameData.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "RenderDevice.h"
 
 
 namespace MC_OpenGL {
 
 
+inline auto SetUniform (GLint location, float value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+inline auto SetUniform (GLint location, int value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+inline auto SetUniform (GLint location, GLuint value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+inline auto SetUniform (GLint location, const glm::vec3 &value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+inline auto SetUniform (GLint location, const glm::vec4 &value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+inline auto SetUniform (GLint location, const glm::mat4 &value) -> void
+	{
+	Device ().SetUniform (location, value);
+	}
+
+
+/// <summary> Whether a uniform of GLSL type type can be set from a T. Samplers and bools are set as int. </summary>
+template <typename T>
+auto IsUniformType (GLenum type) -> bool;
+
+template <>
+inline auto IsUniformType<float> (GLenum type) -> bool
+	{
+	return type == GL_FLOAT;
+	}
+
+template <>
+inline auto IsUniformType<int> (GLenum type) -> bool
+	{
+	switch (type)
+		{
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+template <>
+inline auto IsUniformType<GLuint> (GLenum type) -> bool
+	{
+	return type == GL_UNSIGNED_INT;
+	}
+
+template <>
+inline auto IsUniformType<glm::vec3> (GLenum type) -> bool
+	{
+	return type == GL_FLOAT_VEC3;
+	}
+
+template <>
+inline auto IsUniformType<glm::vec4> (GLenum type) -> bool
+	{
+	return type == GL_FLOAT_VEC4;
+	}
+
+template <>
+inline auto IsUniformType<glm::mat4> (GLenum type) -> bool
+	{
+	return type == GL_FLOAT_MAT4;
+	}
+
+
+/// <summary> Typed handle to a uniform of the program it came from. Set is one uniform call on the
+/// 		  program in use; a default constructed handle, or one for a uniform the linker removed, sets
+/// 		  nothing. </summary>
+template <typename T>
+class Uniform
+	{
+	public:
+		Uniform () = default;
+
+		explicit Uniform (GLint location)
+			: m_Location (location)
+			{
+			}
+
+		auto Set (const T &value) const -> void
+			{
+			if (m_Location >= 0)
+				SetUniform (m_Location, value);
+			}
+
+		explicit operator bool () const
+			{
+			return m_Location >= 0;
+			}
+
+	private:
+		GLint m_Location = -1;
+	};
+
+
+struct ShaderUniform
+	{
+	std::string	name;
+	GLint		location	= -1;
+	GLenum		type		= GL_NONE;
+	GLint		size		= 0;	// Array length, 1 otherwise.
+	};
+
+
+enum class ShaderStatus
+	{
+	Pending,	// Submitted to the driver, which may still be compiling it.
+	Ready,
+	Failed
+	};
+
+
+class ShaderCompiler;
+
+
+/// <summary> A linked GLSL program and its reflected uniforms. Copies share one program, so a copy taken
+/// 		  while a ShaderCompiler is still building it becomes ready along with the original. </summary>
 class Shader
 	{
 	public:
 		Shader ()
+			: m_Program (std::make_shared<Program> ())
 			{
 			// TODO: Provide a default shader.
 			}
 
-		Shader (const std::string &vsFilename, const std::string &fsFilename)
-			: m_ErrorCode (MC_OpenGL::ErrorCode::NONE)
+		/// <summary> Build the program from two GLSL files, waiting for the driver. With a program cache the
+		/// 		  linked binary is loaded when the cache holds one for these sources, and stored after linking
+		/// 		  when it does not. </summary>
+		Shader (const std::string &vsFilename, const std::string &fsFilename, ProgramCache *programCache = nullptr)
+			: m_Program (std::make_shared<Program> ())
+			{
+			Build build;
+			if (Submit (vsFilename, fsFilename, programCache, build))
+				Finish (build);
+			}
+
+		/// <summary> A ready shader for a program built elsewhere, whose active uniforms are given rather than
+		/// 		  queried. Lets drawables render to a device without a GL context. </summary>
+		Shader (GLuint programId, std::vector<ShaderUniform> uniforms)
+			: m_Program (std::make_shared<Program> ())
+			{
+			m_Program->id = programId;
+			m_Program->status = ShaderStatus::Ready;
+			m_Program->uniforms = std::move (uniforms);
+			std::sort (m_Program->uniforms.begin (), m_Program->uniforms.end (), [] (const ShaderUniform &a, const ShaderUniform &b) { return a.name < b.name; });
+			}
+
+		/// <summary> True once the program is linked and may be used. </summary>
+		explicit operator bool () const
+			{
+			return m_Program->status == ShaderStatus::Ready;
+			}
+
+		auto GetProgramId () const
+			{
+			return m_Program->id;
+			}
+
+		auto GetStatus () const -> ShaderStatus
+			{
+			return m_Program->status;
+			}
+
+		auto Use () const
+			{
+			GLState ().UseProgram (m_Program->id);
+			}
+
+		auto GetInfo () const -> std::pair<MC_OpenGL::ErrorCode, std::string>
+			{
+			return { m_Program->errorCode, m_Program->infoLog };
+			}
+
+		/// <summary> Handle to the active uniform name, for arrays its first element. Look handles up once
+		/// 		  and keep them; this is a search by name. An inactive name, or one whose GLSL type does not
+		/// 		  match T, gives a handle that sets nothing, and so does every name while the program is not
+		/// 		  ready. </summary>
+		template <typename T>
+		auto GetUniform (const std::string &name) const -> Uniform<T>
 			{
-			std::ifstream ifs (vsFilename);
+			const ShaderUniform *uniform = FindUniform (name);
+			if (uniform == nullptr)
+				return Uniform<T> ();
+
+			if (!IsUniformType<T> (uniform->type))
+				{
+				std::cerr << "Error: uniform " << name << " does not have the requested type\n";
+				return Uniform<T> ();
+				}
+
+			return Uniform<T> (uniform->location);
+			}
+
+		/// <summary> The active uniforms reflected after linking, sorted by name. </summary>
+		auto GetUniforms () const -> const std::vector<ShaderUniform>&
+			{
+			return m_Program->uniforms;
+			}
+
+		auto SetUniformFloat1f (const std::string name, float value) const -> void
+			{
+			GetUniform<float> (name).Set (value);
+			}
+
+		auto SetVec3(const std::string& name, const glm::vec3& value) const -> void
+		{
+			GetUniform<glm::vec3>(name).Set(value);
+		}
+
+	private:
+		friend class ShaderCompiler;
+
+		struct Program
+			{
+			GLuint						id			= 0;
+			ShaderStatus				status		= ShaderStatus::Failed;
+			ErrorCode					errorCode	= ErrorCode::NONE;
+			std::string					infoLog		= "";
+			std::vector<ShaderUniform>	uniforms;
+			};
+
+		// Shader objects of a submitted program, deleted by Finish.
+		struct Build
+			{
+			GLuint			vsId			= 0;
+			GLuint			fsId			= 0;
+			ContentHash		programKey;
+			ProgramCache	*programCache	= nullptr;
+			};
+
+		static auto ReadSource (const std::string &filename) -> std::string
+			{
+			std::ifstream ifs (filename);
 			std::string line;
 			std::stringstream ss;
 			while (std::getline (ifs, line))
 				ss << line << '\n';
 			ss << '\0';
-			ifs.close ();
+			return ss.str ();
+			}
+
+		// Hand both stages and the link to the driver without asking for any result, so that the driver
+		// may work on them in the background. Returns false if the program came from the cache instead and
+		// is ready already.
+		auto Submit (const std::string &vsFilename, const std::string &fsFilename, ProgramCache *programCache, Build &build) -> bool
+			{
+			const std::string strVsSourceCode = ReadSource (vsFilename);
+			const std::string strFsSourceCode = ReadSource (fsFilename);
 
-			GLuint vsId = glCreateShader (GL_VERTEX_SHADER);
-			std::string strVsSourceCode = ss.str ();
+			if (programCache != nullptr)
+				{
+				build.programKey = programCache->Key (strVsSourceCode, strFsSourceCode);
+				build.programCache = programCache;
+				m_Program->id = programCache->Load (build.programKey);
+				if (m_Program->id != 0)
+					{
+					Reflect ();
+					m_Program->status = ShaderStatus::Ready;
+					return false;
+					}
+				}
+
+			build.vsId = glCreateShader (GL_VERTEX_SHADER);
 			const char *vsSourceCode = strVsSourceCode.c_str ();
-			glShaderSource (vsId, 1, &vsSourceCode, NULL);
-			glCompileShader (vsId);
+			glShaderSource (build.vsId, 1, &vsSourceCode, nullptr);
+			glCompileShader (build.vsId);
+
+			build.fsId = glCreateShader (GL_FRAGMENT_SHADER);
+			const char *fsSourceCode = strFsSourceCode.c_str ();
+			glShaderSource (build.fsId, 1, &fsSourceCode, nullptr);
+			glCompileShader (build.fsId);
+
+			m_Program->id = glCreateProgram ();
+			if (programCache != nullptr)
+				programCache->PrepareLink (m_Program->id);
+			glAttachShader (m_Program->id, build.vsId);
+			glAttachShader (m_Program->id, build.fsId);
+			glLinkProgram (m_Program->id);
+			m_Program->status = ShaderStatus::Pending;
+			return true;
+			}
+
+		// Collect the results of a submitted build. Waits for the driver unless it reported completion.
+		auto Finish (const Build &build) -> void
+			{
 			GLint success;
 			const int infoLogSize = 512;
 			GLchar infoLog[infoLogSize];
-			glGetShaderiv (vsId, GL_COMPILE_STATUS, &success);
+			std::stringstream ssInfoLog;
+			glGetShaderiv (build.vsId, GL_COMPILE_STATUS, &success);
 			if (!success)
 				{
-				glGetShaderInfoLog (vsId, infoLogSize, nullptr, infoLog);
-				std::stringstream ssInfoLog;
+				glGetShaderInfoLog (build.vsId, infoLogSize, nullptr, infoLog);
 				ssInfoLog << "Error: Vertex shader compilation failed\n" << infoLog << std::endl;
-				m_InfoLog = ssInfoLog.str ();
-				m_ErrorCode = MC_OpenGL::ErrorCode::ERROR_VERTEX_SHADER_COMPILATION_FAILED;
-				return;
+				m_Program->errorCode = MC_OpenGL::ErrorCode::ERROR_VERTEX_SHADER_COMPILATION_FAILED;
 				}
-
-			ifs.open (fsFilename);
-			ss = std::stringstream ();
-			while (std::getline (ifs, line))
-				ss << line << '\n';
-			ss << '\0';
-			ifs.close ();
-
-			GLuint fsId = glCreateShader (GL_FRAGMENT_SHADER);
-			std::string strFsSourceCode = ss.str ();
-			const char *fsSourceCode = strFsSourceCode.c_str ();
-			glShaderSource (fsId, 1, &fsSourceCode, nullptr);
-			glCompileShader (fsId);
-			glGetShaderiv (fsId, GL_COMPILE_STATUS, &success);
-			if (!success)
+			else
 				{
-				glGetShaderInfoLog (fsId, infoLogSize, nullptr, infoLog);
-				std::stringstream ssInfoLog;
-				ssInfoLog << "Error: Fragment shader compilation failed\n" << infoLog << std::endl;
-				m_InfoLog = ssInfoLog.str ();
-				m_ErrorCode = MC_OpenGL::ErrorCode::ERROR_FRAGMENT_SHADER_COMPILATION_FAILED;
-				return;
+				glGetShaderiv (build.fsId, GL_COMPILE_STATUS, &success);
+				if (!success)
+					{
+					glGetShaderInfoLog (build.fsId, infoLogSize, nullptr, infoLog);
+					ssInfoLog << "Error: Fragment shader compilation failed\n" << infoLog << std::endl;
+					m_Program->errorCode = MC_OpenGL::ErrorCode::ERROR_FRAGMENT_SHADER_COMPILATION_FAILED;
+					}
+				else
+					{
+					glGetProgramiv (m_Program->id, GL_LINK_STATUS, &success);
+					if (!success)
+						{
+						glGetProgramInfoLog (m_Program->id, infoLogSize, nullptr, infoLog);
+						ssInfoLog << "Error: Shader program linking failed\n" << infoLog << std::endl;
+						m_Program->errorCode = MC_OpenGL::ErrorCode::ERROR_SHADER_PROGRAM_LINKING_FAILED;
+						}
+					}
 				}
 
-			m_Id = glCreateProgram ();
-			glAttachShader (m_Id, vsId);
-			glAttachShader (m_Id, fsId);
-			glLinkProgram (m_Id);
-			glGetShaderiv (m_Id, GL_LINK_STATUS, &success);
-			if (!success)
+			glDeleteShader (build.vsId);
+			glDeleteShader (build.fsId);
+
+			if (m_Program->errorCode != MC_OpenGL::ErrorCode::NONE)
 				{
-				glGetProgramInfoLog (m_Id, infoLogSize, nullptr, infoLog);
-				std::stringstream ssInfoLog;
-				ssInfoLog << "Error: Shader program linking failed\n" << infoLog << std::endl;
-				m_InfoLog = ssInfoLog.str ();
-				m_ErrorCode = MC_OpenGL::ErrorCode::ERROR_SHADER_PROGRAM_LINKING_FAILED;
+				m_Program->infoLog = ssInfoLog.str ();
+				glDeleteProgram (m_Program->id);
+				m_Program->id = 0;
+				m_Program->status = ShaderStatus::Failed;
+				return;
 				}
 
-			glDeleteShader (vsId);
-			glDeleteShader (vsId);
+			if (build.programCache != nullptr)
+				build.programCache->Store (build.programKey, m_Program->id);
+			Reflect ();
+			m_Program->status = ShaderStatus::Ready;
 			}
 
-		operator bool () const
+		auto FindUniform (const std::string &name) const -> const ShaderUniform *
 			{
-			return m_ErrorCode == MC_OpenGL::ErrorCode::NONE;
+			const std::vector<ShaderUniform> &uniforms = m_Program->uniforms;
+			auto found = std::lower_bound (uniforms.begin (), uniforms.end (), name, [] (const ShaderUniform &uniform, const std::string &key) { return uniform.name < key; });
+			if (found == uniforms.end () || found->name != name)
+				return nullptr;
+			return &*found;
 			}
 
-		auto GetProgramId () const
+		// Query every active uniform once, so that nothing asks the driver for a location by name later.
+		auto Reflect () -> void
 			{
-			return m_Id;
-			}
+			const GLuint id = m_Program->id;
+			std::vector<ShaderUniform> &uniforms = m_Program->uniforms;
+			GLint count = 0;
+			GLint maxLength = 0;
+			glGetProgramiv (id, GL_ACTIVE_UNIFORMS, &count);
+			glGetProgramiv (id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-		auto Use () const
-			{
-			glUseProgram (m_Id);
-			}
+			std::vector<GLchar> buffer (std::max (maxLength, 1));
+			for (GLint i = 0; i < count; ++i)
+				{
+				ShaderUniform uniform;
+				GLsizei length = 0;
+				glGetActiveUniform (id, static_cast<GLuint> (i), static_cast<GLsizei> (buffer.size ()), &length, &uniform.size, &uniform.type, buffer.data ());
+				uniform.name.assign (buffer.data (), length);
 
-		auto GetInfo () const -> std::pair<MC_OpenGL::ErrorCode, std::string>
-			{
-			return { m_ErrorCode, m_InfoLog };
-			}
+				// Uniforms in blocks have no location and are set through their buffer.
+				uniform.location = glGetUniformLocation (id, uniform.name.c_str ());
+				if (uniform.location < 0)
+					continue;
 
-		auto SetUniformFloat1f (const std::string name, float value) const -> void
-			{
-			glUniform1f (glGetUniformLocation (m_Id, name.c_str ()), value);
-			}
+				// Arrays are reported as name[0]; look them up by their plain name.
+				if (uniform.name.size () > 3 && uniform.name.compare (uniform.name.size () - 3, 3, "[0]") == 0)
+					uniform.name.resize (uniform.name.size () - 3);
 
-		auto SetVec3(const std::string& name, const glm::vec3& value) const -> void
-		{
-			glUniform3fv(glGetUniformLocation(m_Id, name.c_str()), 1, &value[0]);
-		}
+				uniforms.push_back (std::move (uniform));
+				}
 
-	private:
-		GLuint      m_Id = 0;
-		ErrorCode	m_ErrorCode = ErrorCode::NONE;
-		std::string m_InfoLog = "";
+			std::sort (uniforms.begin (), uniforms.end (), [] (const ShaderUniform &a, const ShaderUniform &b) { return a.name < b.name; });
+
+			// GLSL 3.30 cannot give a block a binding point itself.
+			GLuint frameDataIndex = glGetUniformBlockIndex (id, FrameDataBlockName);
+			if (frameDataIndex != GL_INVALID_INDEX)
+				glUniformBlockBinding (id, frameDataIndex, FrameDataBinding);
+			}
+
+		std::shared_ptr<Program>	m_Program;
 	};
 
 
@@ -0,0 +1,93 @@
+#include "ShaderCompiler.h"
+
+#include <iostream>
+
+#include <GLFW/glfw3.h>
+
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+
+MC_OpenGL::ShaderCompiler::ShaderCompiler(ProgramCache& programs)
+	: m_Programs(programs)
+{
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Finish(PendingBuild& pending) -> void
+{
+	pending.shader.Finish(pending.build);
+	if (!pending.shader)
+		std::cerr << pending.shader.GetInfo().second;
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Initialize() -> void
+{
+	// The ARB version of the extension shares the enum and only differs in the function's name.
+	MaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+	if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+		maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+	else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+		maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+
+	m_CompletionStatus = maxShaderCompilerThreads != nullptr;
+	if (m_CompletionStatus)
+		maxShaderCompilerThreads(0xFFFFFFFF);
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Pending() const -> std::size_t
+{
+	return m_Pending.size();
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Release() -> void
+{
+	for (const PendingBuild& pending : m_Pending)
+	{
+		glDeleteShader(pending.build.vsId);
+		glDeleteShader(pending.build.fsId);
+	}
+	m_Pending.clear();
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Submit(const std::string& vsFilename, const std::string& fsFilename) -> Shader
+{
+	PendingBuild pending;
+	if (pending.shader.Submit(vsFilename, fsFilename, &m_Programs, pending.build))
+		m_Pending.push_back(pending);
+	return pending.shader;
+}
+
+
+auto MC_OpenGL::ShaderCompiler::Update() -> void
+{
+	if (m_Pending.empty())
+		return;
+
+	if (!m_CompletionStatus)
+	{
+		Finish(m_Pending.front());
+		m_Pending.erase(m_Pending.begin());
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_Pending.size();)
+	{
+		GLint complete = GL_FALSE;
+		glGetProgramiv(m_Pending[i].shader.GetProgramId(), GL_COMPLETION_STATUS_KHR, &complete);
+		if (!complete)
+		{
+			++i;
+			continue;
+		}
+
+		Finish(m_Pending[i]);
+		m_Pending.erase(m_Pending.begin() + i);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "ProgramCache.h"
+#include "Shader.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Builds shader programs without waiting for the driver. Submit hands the sources to GL and
+	/// 		  returns a pending Shader at once, so every program can be submitted up front and compiled in
+	/// 		  parallel by the driver. Update polls them with KHR_parallel_shader_compile and never blocks;
+	/// 		  without the extension it finishes one program per call, which waits on that one only. Anything
+	/// 		  drawn with a shader that is not ready yet is skipped. </summary>
+	class ShaderCompiler
+	{
+	public:
+		ShaderCompiler(const ShaderCompiler&) = delete;
+		auto operator=(const ShaderCompiler&) -> ShaderCompiler& = delete;
+
+		/// <summary> Programs are looked up in, and stored to, programs. </summary>
+		explicit ShaderCompiler(ProgramCache& programs);
+
+		/// <summary> Look up the extension and let the driver use as many compiler threads as it likes.
+		/// 		  Call once the context is current. </summary>
+		auto Initialize() -> void;
+		auto Pending() const -> std::size_t;
+
+		/// <summary> Delete the shader objects of programs still being built. Call while the context is still
+		/// 		  current. </summary>
+		auto Release() -> void;
+
+		/// <summary> A shader for the two GLSL files, ready at once when the program cache holds it and
+		/// 		  pending otherwise. </summary>
+		auto Submit(const std::string& vsFilename, const std::string& fsFilename) -> Shader;
+
+		/// <summary> Make the programs the driver has finished ready, or failed with their info log printed.
+		/// 		  Call once per frame. </summary>
+		auto Update() -> void;
+
+	private:
+		using MaxShaderCompilerThreadsProc = void (APIENTRY*)(GLuint count);
+
+		struct PendingBuild
+		{
+			Shader			shader;
+			Shader::Build	build;
+		};
+
+		auto Finish(PendingBuild& pending) -> void;
+
+		ProgramCache&				m_Programs;
+		std::vector<PendingBuild>	m_Pending;
+		bool						m_CompletionStatus	= false;	// Whether the driver can be asked if a build is done.
+	};
+
+
+}
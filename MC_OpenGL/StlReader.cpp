@@ -0,0 +1,245 @@
+#include "StlReader.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "MappedFile.h"
+#include "Parallel.h"
+
+
+namespace {
+
+
+// Binary STL: 80 byte header, uint32 facet count, then one 50 byte record per facet
+// (normal, three vertices, uint16 attribute byte count), all little-endian.
+constexpr std::size_t binaryHeaderSize	= 84;
+constexpr std::size_t binaryFacetSize	= 50;
+
+// How much of the start of a file has to read as text for it to be taken as ASCII.
+constexpr std::size_t asciiProbeSize	= 512;
+
+
+auto BinaryFacetCount(const char* data) -> std::uint32_t
+{
+	std::uint32_t count;
+	std::memcpy(&count, data + 80, sizeof(count));
+	return count;
+}
+
+
+auto IsSpace(char c) -> bool
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+
+auto SkipSpace(const char* p, const char* end) -> const char*
+{
+	while (p < end && IsSpace(*p))
+		++p;
+	return p;
+}
+
+
+auto NextWord(const char*& p, const char* end) -> std::string_view
+{
+	p = SkipSpace(p, end);
+	const char* begin = p;
+	while (p < end && !IsSpace(*p))
+		++p;
+	return std::string_view(begin, p - begin);
+}
+
+
+auto NextFloat(const char*& p, const char* end) -> float
+{
+	p = SkipSpace(p, end);
+	if (p < end && *p == '+')
+		++p;
+
+	float value = 0.f;
+	auto result = std::from_chars(p, end, value);
+	p = result.ptr;
+	while (p < end && !IsSpace(*p))
+		++p;
+	return value;
+}
+
+
+/// ASCII files start with "solid" and are printable text that reaches a "facet" or "endsolid" keyword
+/// early on. Binary headers often start with "solid" too, but the facet records after them are not text.
+auto LooksLikeAscii(const char* data, std::size_t size) -> bool
+{
+	const char* end = data + std::min(size, asciiProbeSize);
+	const char* p = SkipSpace(data, end);
+	if (std::string_view(p, end - p).substr(0, 5) != "solid")
+		return false;
+
+	const bool printable = std::all_of(p, end, [](char c) { return IsSpace(c) || (c >= 0x20 && c < 0x7F); });
+	const std::string_view text(p, end - p);
+	return printable && (text.find("facet") != std::string_view::npos || text.find("endsolid") != std::string_view::npos);
+}
+
+
+/// Returns the offset of the first "facet" keyword at or after pos, or size if there is none.
+/// "endfacet" is not a match because the keyword has to start a word.
+auto FindFacet(const char* data, std::size_t size, std::size_t pos) -> std::size_t
+{
+	std::string_view text(data, size);
+	while ((pos = text.find("facet", pos)) != std::string_view::npos)
+	{
+		if (pos == 0 || IsSpace(data[pos - 1]))
+			return pos;
+		pos += 5;
+	}
+	return size;
+}
+
+
+auto ParseAsciiChunk(const char* p, const char* end, std::vector<float>& vertices) -> void
+{
+	// Roughly 250 bytes of text per facet in typical exporter output.
+	vertices.reserve((end - p) / 250 * MC_OpenGL::StlFloatsPerFacet + MC_OpenGL::StlFloatsPerFacet);
+
+	std::array<float, 3> normal{ 0.f, 0.f, 0.f };
+	while (p < end)
+	{
+		std::string_view word = NextWord(p, end);
+		if (word == "facet")
+		{
+			NextWord(p, end);
+			normal[0] = NextFloat(p, end);
+			normal[1] = NextFloat(p, end);
+			normal[2] = NextFloat(p, end);
+		}
+		else if (word == "vertex")
+		{
+			float x = NextFloat(p, end);
+			float y = NextFloat(p, end);
+			float z = NextFloat(p, end);
+
+			vertices.insert(vertices.end(), { x, y, z, 0.f, 0.f, normal[0], normal[1], normal[2] });
+		}
+	}
+}
+
+
+auto ReadStlAscii(const char* data, std::size_t size, std::vector<float>& vertices) -> MC_OpenGL::ErrorCode
+{
+	// Cut the file into one chunk per worker, moving every cut forward to the start of a facet
+	// so that each chunk can be parsed on its own.
+	const std::size_t numChunks = std::min(MC_OpenGL::WorkerCount(), std::max<std::size_t>(1, size / (1 << 20)));
+	std::vector<std::size_t> cuts(numChunks + 1, size);
+	cuts[0] = 0;
+	for (std::size_t i = 1; i < numChunks; ++i)
+		cuts[i] = FindFacet(data, size, std::max(cuts[i - 1], i * (size / numChunks)));
+
+	std::vector<std::vector<float> > chunks(numChunks);
+	MC_OpenGL::ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			ParseAsciiChunk(data + cuts[i], data + cuts[i + 1], chunks[i]);
+	});
+
+	// Stitch the chunks together in file order.
+	std::vector<std::size_t> offsets(numChunks + 1, 0);
+	for (std::size_t i = 0; i < numChunks; ++i)
+		offsets[i + 1] = offsets[i] + chunks[i].size();
+
+	vertices.resize(offsets[numChunks]);
+	float* out = vertices.data();
+	MC_OpenGL::ParallelFor(numChunks, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			std::copy(chunks[i].begin(), chunks[i].end(), out + offsets[i]);
+	});
+
+	// No facets, or a vertex missing from one, means this was not an STL file we can read.
+	if (vertices.empty() || vertices.size() % MC_OpenGL::StlFloatsPerFacet != 0)
+	{
+		vertices.clear();
+		return MC_OpenGL::ErrorCode::ERROR_STL_FAILED_TO_LOAD;
+	}
+	return MC_OpenGL::ErrorCode::NONE;
+}
+
+
+auto ReadStlBinary(const char* data, std::size_t size, std::vector<float>& vertices) -> MC_OpenGL::ErrorCode
+{
+	const std::size_t numFacets = BinaryFacetCount(data);
+	if (numFacets == 0 || binaryHeaderSize + numFacets * binaryFacetSize > size)
+		return MC_OpenGL::ErrorCode::ERROR_STL_FAILED_TO_LOAD;
+
+	vertices.resize(numFacets * MC_OpenGL::StlFloatsPerFacet);
+
+	const char* facets = data + binaryHeaderSize;
+	float* out = vertices.data();
+	MC_OpenGL::ParallelFor(numFacets, 1 << 16, [facets, out](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			// The records are 50 bytes so the floats are not aligned; copy them out bytewise.
+			float record[12];
+			std::memcpy(record, facets + i * binaryFacetSize, sizeof(record));
+
+			float* facet = out + i * MC_OpenGL::StlFloatsPerFacet;
+			for (int v = 0; v < 3; ++v)
+			{
+				float* vertex = facet + v * MC_OpenGL::StlFloatsPerVertex;
+				vertex[0] = record[3 + 3 * v];
+				vertex[1] = record[4 + 3 * v];
+				vertex[2] = record[5 + 3 * v];
+				vertex[3] = 0.f;
+				vertex[4] = 0.f;
+				vertex[5] = record[0];
+				vertex[6] = record[1];
+				vertex[7] = record[2];
+			}
+		}
+	});
+
+	return MC_OpenGL::ErrorCode::NONE;
+}
+
+
+}
+
+
+auto MC_OpenGL::DetectStlFormat(const char* data, std::size_t size) -> StlFormat
+{
+	if (LooksLikeAscii(data, size))
+		return StlFormat::Ascii;
+
+	// Some exporters pad binary files or leave a few bytes after the last facet.
+	if (size >= binaryHeaderSize && binaryHeaderSize + std::size_t(BinaryFacetCount(data)) * binaryFacetSize <= size)
+		return StlFormat::Binary;
+
+	return StlFormat::Ascii;
+}
+
+
+auto MC_OpenGL::ReadStl(const std::string& filename, std::vector<float>& vertices) -> ErrorCode
+{
+	vertices.clear();
+
+	MappedFile file(filename);
+	if (!file)
+		return ErrorCode::ERROR_STL_FAILED_TO_LOAD;
+
+	return ReadStl(file.Data(), file.Size(), vertices);
+}
+
+
+auto MC_OpenGL::ReadStl(const char* data, std::size_t size, std::vector<float>& vertices) -> ErrorCode
+{
+	vertices.clear();
+
+	if (DetectStlFormat(data, size) == StlFormat::Binary)
+		return ReadStlBinary(data, size, vertices);
+
+	return ReadStlAscii(data, size, vertices);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ErrorCode.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	enum class StlFormat
+	{
+		Ascii,
+		Binary
+	};
+
+
+	// Layout of one vertex in the buffers produced by ReadStl: position (3), texture coords (2), normal (3).
+	constexpr std::size_t StlFloatsPerVertex	= 8;
+	constexpr std::size_t StlNormalOffset		= 5;
+	constexpr std::size_t StlFloatsPerFacet		= 3 * StlFloatsPerVertex;
+
+
+	auto DetectStlFormat(const char* data, std::size_t size) -> StlFormat;
+
+	/// <summary> Load an ASCII or binary STL file into an interleaved, non-indexed vertex buffer. </summary>
+	///
+	/// <param name="filename"> The STL file. The format is detected from the contents. </param>
+	/// <param name="vertices"> [out] StlFloatsPerVertex floats per vertex, three vertices per facet. </param>
+	///
+	/// <returns> A MC_OpenGL::ErrorCode. </returns>
+	auto ReadStl(const std::string& filename, std::vector<float>& vertices) -> ErrorCode;
+
+	/// <summary> The same for an STL file already in memory, e.g. mapped to hash it first. </summary>
+	auto ReadStl(const char* data, std::size_t size, std::vector<float>& vertices) -> ErrorCode;
+
+
+}
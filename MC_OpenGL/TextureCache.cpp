@@ -0,0 +1,323 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#include <emmintrin.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Parallel.h"
+
+
+namespace {
+
+
+constexpr char			cacheMagic[4]		= { 'M', 'C', 'T', 'X' };
+constexpr std::uint32_t	cacheVersion		= 3;
+constexpr std::size_t	cacheAlignment		= 16;
+constexpr char			cacheExtension[]	= ".mctx";
+
+
+// File layout: header, one LevelRecord per level, then the levels at their offsets from the start of the file.
+struct CacheHeader
+{
+	char			magic[4];
+	std::uint32_t	version;
+	std::uint64_t	sourceHashLow;
+	std::uint64_t	sourceHashHigh;
+	std::uint64_t	sourceSize;
+	std::uint32_t	width;
+	std::uint32_t	height;
+	std::uint32_t	channels;
+	std::uint32_t	numLevels;
+};
+
+
+struct LevelRecord
+{
+	std::uint32_t	width;
+	std::uint32_t	height;
+	std::uint64_t	offset;
+	std::uint64_t	size;
+};
+
+
+auto AlignUp(std::size_t value) -> std::size_t
+{
+	return (value + cacheAlignment - 1) / cacheAlignment * cacheAlignment;
+}
+
+
+// Same rounding as the SSE2 path: (a + b + c + d + 2) / 4 per channel.
+auto AveragePixel(const unsigned char* row0, const unsigned char* row1, int x0, int x1, unsigned char* out) -> void
+{
+	for (int c = 0; c < MC_OpenGL::TextureCacheChannels; ++c)
+	{
+		const int sum = row0[4 * x0 + c] + row0[4 * x1 + c] + row1[4 * x0 + c] + row1[4 * x1 + c];
+		out[c] = static_cast<unsigned char>((sum + 2) >> 2);
+	}
+}
+
+
+}
+
+
+auto MC_OpenGL::BakeMipChain(const char* encoded, std::size_t size, MipChain& chain) -> ErrorCode
+{
+	int width, height, channels;
+	unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encoded), static_cast<int>(size), &width, &height, &channels, TextureCacheChannels);
+	if (data == nullptr)
+		return ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD;
+
+	chain = MipChain();
+	std::size_t total = 0;
+	for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+	{
+		const std::size_t levelSize = static_cast<std::size_t>(w) * h * TextureCacheChannels;
+		chain.levels.push_back({ w, h, total, levelSize });
+		total += AlignUp(levelSize);
+		if (w == 1 && h == 1)
+			break;
+	}
+	chain.storage.resize(total);
+
+	// stb_image returns the top row first; OpenGL wants the bottom row first.
+	const std::size_t rowBytes = static_cast<std::size_t>(width) * TextureCacheChannels;
+	for (int row = 0; row < height; ++row)
+		std::memcpy(chain.storage.data() + (height - 1 - row) * rowBytes, data + row * rowBytes, rowBytes);
+	stbi_image_free(data);
+
+	for (std::size_t level = 1; level < chain.levels.size(); ++level)
+	{
+		const MipLevel& source = chain.levels[level - 1];
+		DownsampleRgba(chain.storage.data() + source.offset, source.width, source.height, chain.storage.data() + chain.levels[level].offset);
+	}
+
+	return ErrorCode::NONE;
+}
+
+
+auto MC_OpenGL::DownsampleRgba(const unsigned char* source, int width, int height, unsigned char* destination) -> void
+{
+	const int outWidth = std::max(1, width / 2);
+	const int outHeight = std::max(1, height / 2);
+	const std::size_t sourceStride = static_cast<std::size_t>(width) * TextureCacheChannels;
+	const std::size_t destinationStride = static_cast<std::size_t>(outWidth) * TextureCacheChannels;
+
+	ParallelFor(outHeight, std::max(1, (1 << 16) / outWidth), [&](std::size_t begin, std::size_t end)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i two = _mm_set1_epi16(2);
+
+		for (std::size_t y = begin; y < end; ++y)
+		{
+			const unsigned char* row0 = source + std::min<std::size_t>(2 * y, height - 1) * sourceStride;
+			const unsigned char* row1 = source + std::min<std::size_t>(2 * y + 1, height - 1) * sourceStride;
+			unsigned char* out = destination + y * destinationStride;
+
+			// With width >= 2 every output pixel has both source columns, so four source pixels can be read
+			// for every two output pixels.
+			int x = 0;
+			if (width > 1)
+			{
+				for (; x + 2 <= outWidth; x += 2)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+					const __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+					const __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+					__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+					sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, sum));
+				}
+			}
+			for (; x < outWidth; ++x)
+				AveragePixel(row0, row1, std::min(2 * x, width - 1), std::min(2 * x + 1, width - 1), out + 4 * x);
+		}
+	});
+}
+
+
+auto MC_OpenGL::LoadCachedTexture(const std::string& source, const std::filesystem::path& cacheDirectory, MipChain& chain) -> ErrorCode
+{
+	MappedFile file(source);
+	if (!file)
+		return ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD;
+
+	// Reading the image size from its header is cheap and lets a hit be checked against the source.
+	TextureCacheKey key;
+	key.sourceHash = HashBytes(file.Data(), file.Size());
+	key.sourceSize = file.Size();
+	int channels;
+	if (!stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(file.Data()), static_cast<int>(file.Size()), &key.width, &key.height, &channels))
+		return ErrorCode::ERROR_TEXTURE_FAILED_TO_LOAD;
+
+	std::error_code error;
+	const std::filesystem::path cacheFile = TextureCachePath(cacheDirectory, key.sourceHash);
+	if (ReadTextureCache(cacheFile, key, chain) == ErrorCode::NONE)
+	{
+		std::filesystem::last_write_time(cacheFile, std::filesystem::file_time_type::clock::now(), error);
+		return ErrorCode::NONE;
+	}
+
+	ErrorCode errorCode = BakeMipChain(file.Data(), file.Size(), chain);
+	if (errorCode != ErrorCode::NONE)
+		return errorCode;
+
+	// A cache that cannot be written only costs the next launch a decode.
+	std::filesystem::create_directories(cacheDirectory, error);
+	if (WriteTextureCache(cacheFile, key, chain) != ErrorCode::NONE)
+		std::cerr << "Warning: failed to write texture cache " << cacheFile.string() << '\n';
+	else
+		TrimTextureCache(cacheDirectory, TextureCacheLimit);
+
+	return ErrorCode::NONE;
+}
+
+
+auto MC_OpenGL::ReadTextureCache(const std::filesystem::path& filename, const TextureCacheKey& key, MipChain& chain) -> ErrorCode
+{
+	auto mapping = std::make_shared<MappedFile>(filename.string());
+	if (!*mapping || mapping->Size() < sizeof(CacheHeader))
+		return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+
+	CacheHeader header;
+	std::memcpy(&header, mapping->Data(), sizeof(header));
+	if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion || header.sourceHashLow != key.sourceHash.low || header.sourceHashHigh != key.sourceHash.high
+		|| header.sourceSize != key.sourceSize || header.width != static_cast<std::uint32_t>(key.width) || header.height != static_cast<std::uint32_t>(key.height)
+		|| header.channels != TextureCacheChannels || header.numLevels == 0 || header.numLevels > 64)
+		return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+
+	const std::size_t recordsEnd = sizeof(CacheHeader) + header.numLevels * sizeof(LevelRecord);
+	if (mapping->Size() < recordsEnd)
+		return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+
+	// Level offsets are stored from the start of the file; the chain keeps them relative to the first level.
+	MipChain result;
+	std::uint32_t width = header.width;
+	std::uint32_t height = header.height;
+	for (std::uint32_t i = 0; i < header.numLevels; ++i)
+	{
+		LevelRecord record;
+		std::memcpy(&record, mapping->Data() + sizeof(CacheHeader) + i * sizeof(LevelRecord), sizeof(record));
+		if (record.width != width || record.height != height || (i + 1 == header.numLevels) != (width == 1 && height == 1))
+			return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+		width = std::max<std::uint32_t>(1, width / 2);
+		height = std::max<std::uint32_t>(1, height / 2);
+
+		if (record.offset < recordsEnd || record.offset > mapping->Size() || record.size > mapping->Size() - record.offset
+			|| record.size != static_cast<std::uint64_t>(record.width) * record.height * TextureCacheChannels)
+			return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+
+		if (i == 0)
+			result.mappingOffset = static_cast<std::size_t>(record.offset);
+		if (record.offset < result.mappingOffset)
+			return ErrorCode::ERROR_TEXTURE_CACHE_INVALID;
+		result.levels.push_back({ static_cast<int>(record.width), static_cast<int>(record.height), static_cast<std::size_t>(record.offset) - result.mappingOffset, static_cast<std::size_t>(record.size) });
+	}
+
+	result.mapping = std::move(mapping);
+	chain = std::move(result);
+	return ErrorCode::NONE;
+}
+
+
+auto MC_OpenGL::TextureCachePath(const std::filesystem::path& cacheDirectory, const ContentHash& sourceHash) -> std::filesystem::path
+{
+	return cacheDirectory / (HashToHex(sourceHash) + cacheExtension);
+}
+
+
+auto MC_OpenGL::TrimTextureCache(const std::filesystem::path& cacheDirectory, std::uintmax_t maxBytes) -> void
+{
+	struct CacheFile
+	{
+		std::filesystem::path			path;
+		std::filesystem::file_time_type	time;
+		std::uintmax_t					size;
+	};
+
+	std::error_code error;
+	std::vector<CacheFile> files;
+	std::uintmax_t total = 0;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cacheDirectory, error))
+	{
+		if (entry.path().extension() != cacheExtension)
+			continue;
+
+		// Another loader may delete or replace a file meanwhile; such files are simply left alone.
+		const std::filesystem::file_time_type time = entry.last_write_time(error);
+		const std::uintmax_t size = error ? 0 : entry.file_size(error);
+		if (error)
+			continue;
+
+		files.push_back({ entry.path(), time, size });
+		total += size;
+	}
+
+	std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.time < b.time; });
+	for (std::size_t i = 0; total > maxBytes && i + 1 < files.size(); ++i)
+	{
+		if (std::filesystem::remove(files[i].path, error))
+			total -= files[i].size;
+	}
+}
+
+
+auto MC_OpenGL::WriteTextureCache(const std::filesystem::path& filename, const TextureCacheKey& key, const MipChain& chain) -> ErrorCode
+{
+	if (chain.levels.empty())
+		return ErrorCode::ERROR_TEXTURE_CACHE_WRITE_FAILED;
+
+	CacheHeader header;
+	std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.version = cacheVersion;
+	header.sourceHashLow = key.sourceHash.low;
+	header.sourceHashHigh = key.sourceHash.high;
+	header.sourceSize = key.sourceSize;
+	header.width = static_cast<std::uint32_t>(chain.levels.front().width);
+	header.height = static_cast<std::uint32_t>(chain.levels.front().height);
+	header.channels = TextureCacheChannels;
+	header.numLevels = static_cast<std::uint32_t>(chain.levels.size());
+
+	const std::size_t dataOffset = AlignUp(sizeof(CacheHeader) + chain.levels.size() * sizeof(LevelRecord));
+	std::vector<LevelRecord> records;
+	for (const MipLevel& level : chain.levels)
+		records.push_back({ static_cast<std::uint32_t>(level.width), static_cast<std::uint32_t>(level.height), dataOffset + level.offset, level.size });
+
+	// Written under a name of this writer's own and renamed, so a reader never maps a half written file and
+	// two threads baking the same contents never write into one file.
+	const std::filesystem::path temporary = TemporaryPath(filename);
+	std::error_code error;
+	{
+		std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(LevelRecord));
+
+		const char padding[cacheAlignment] = {};
+		ofs.write(padding, dataOffset - sizeof(header) - records.size() * sizeof(LevelRecord));
+
+		const MipLevel& last = chain.levels.back();
+		ofs.write(reinterpret_cast<const char*>(chain.Pixels()), last.offset + last.size);
+		ofs.close();
+		if (!ofs)
+		{
+			std::filesystem::remove(temporary, error);
+			return ErrorCode::ERROR_TEXTURE_CACHE_WRITE_FAILED;
+		}
+	}
+
+	std::filesystem::rename(temporary, filename, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return ErrorCode::ERROR_TEXTURE_CACHE_WRITE_FAILED;
+	}
+
+	return ErrorCode::NONE;
+}
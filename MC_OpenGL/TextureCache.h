@@ -0,0 +1,90 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ErrorCode.h"
+#include "Hash.h"
+#include "MappedFile.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	// Cached images are always RGBA8; the GPU pads RGB to four channels anyway.
+	constexpr int TextureCacheChannels = 4;
+
+	// LoadCachedTexture deletes the least recently used cache files beyond this many bytes.
+	constexpr std::uintmax_t TextureCacheLimit = std::uintmax_t(1) << 30;
+
+
+	/// <summary> What a cache file must have been baked from: the source's contents and the image size its
+	/// 		  header reports. </summary>
+	struct TextureCacheKey
+	{
+		ContentHash		sourceHash;
+		std::uint64_t	sourceSize	= 0;
+		int				width		= 0;
+		int				height		= 0;
+	};
+
+
+	struct MipLevel
+	{
+		int			width	= 0;
+		int			height	= 0;
+		std::size_t	offset	= 0;	// From Pixels().
+		std::size_t	size	= 0;
+	};
+
+
+	/// <summary> Every mip level of an RGBA8 image down to 1x1, rows bottom first and tightly packed. The
+	/// 		  pixels are either owned or read straight from a mapped cache file. </summary>
+	struct MipChain
+	{
+		std::vector<MipLevel>		levels;
+		std::vector<unsigned char>	storage;
+		std::shared_ptr<MappedFile>	mapping;
+		std::size_t					mappingOffset	= 0;
+
+		auto Pixels() const -> const unsigned char*
+		{
+			return mapping ? reinterpret_cast<const unsigned char*>(mapping->Data()) + mappingOffset : storage.data();
+		}
+	};
+
+
+	/// <summary> Decode an image with stb_image, flip it bottom row first, expand it to RGBA and build the
+	/// 		  mip chain with a 2x2 box filter. </summary>
+	auto BakeMipChain(const char* encoded, std::size_t size, MipChain& chain) -> ErrorCode;
+
+	/// <summary> Halve an RGBA8 image, rounding odd sizes down, the way glGenerateMipmap does. Rows are split
+	/// 		  across worker threads and each row is filtered two pixels per SSE2 step. </summary>
+	auto DownsampleRgba(const unsigned char* source, int width, int height, unsigned char* destination) -> void;
+
+	/// <summary> Name of the cache file for a source with the given content hash. </summary>
+	auto TextureCachePath(const std::filesystem::path& cacheDirectory, const ContentHash& sourceHash) -> std::filesystem::path;
+
+	/// <summary> Map a cache file. Fails if it is missing, damaged, was baked from other contents or its
+	/// 		  levels are not the full chain of the key's image size. </summary>
+	auto ReadTextureCache(const std::filesystem::path& filename, const TextureCacheKey& key, MipChain& chain) -> ErrorCode;
+	auto WriteTextureCache(const std::filesystem::path& filename, const TextureCacheKey& key, const MipChain& chain) -> ErrorCode;
+
+	/// <summary> Delete the least recently used cache files until the rest take at most maxBytes. The most
+	/// 		  recent file is always kept. </summary>
+	auto TrimTextureCache(const std::filesystem::path& cacheDirectory, std::uintmax_t maxBytes) -> void;
+
+	/// <summary> Mip chain of an image file, from the cache when it holds one for the file's current contents.
+	/// 		  Otherwise the file is baked, the cache file written for next time and the cache trimmed to
+	/// 		  TextureCacheLimit. A hit refreshes the file's modification time, which is what trimming
+	/// 		  goes by. </summary>
+	auto LoadCachedTexture(const std::string& source, const std::filesystem::path& cacheDirectory, MipChain& chain) -> ErrorCode;
+
+
+}
@@ -0,0 +1,247 @@
+#include "TextureManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "GLState.h"
+#include "Parallel.h"
+
+
+namespace {
+
+
+auto DeleteImage(MC_OpenGL::TextureImage* image) -> void
+{
+	// The placeholder is shared and owned by the manager.
+	if (image->resident)
+		MC_OpenGL::GLState().DeleteTexture(image->id);
+	delete image;
+}
+
+
+}
+
+
+MC_OpenGL::TextureManager::TextureManager(const std::filesystem::path& cacheDirectory)
+	: m_CacheDirectory(cacheDirectory)
+{
+}
+
+
+auto MC_OpenGL::Texture::Bind(GLuint unit) const -> void
+{
+	GLState().BindTexture(unit, image ? image->id : 0);
+	GLState().BindSampler(unit, sampler);
+}
+
+
+auto MC_OpenGL::TextureManager::Load(const std::string& path, const SamplerState& samplerState) -> Texture
+{
+	auto cached = m_Images.find(path);
+	if (cached != m_Images.end())
+	{
+		if (std::shared_ptr<const TextureImage> image = cached->second.lock())
+		{
+			++m_Hits;
+			return Texture{ image, Sampler(samplerState) };
+		}
+	}
+
+	std::shared_ptr<TextureImage> image(new TextureImage(), DeleteImage);
+	image->id = Placeholder();
+	image->path = path;
+
+	PendingUpload pending;
+	pending.image = image;
+	m_Pending.push_back(std::move(pending));
+	++m_Decodes;
+	StartDecodes();
+
+	m_Images[path] = image;
+	return Texture{ image, Sampler(samplerState) };
+}
+
+
+auto MC_OpenGL::TextureManager::Placeholder() -> GLuint
+{
+	if (m_Placeholder == 0)
+	{
+		const unsigned char white[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &m_Placeholder);
+		GLState().BindForEdit(0, m_Placeholder);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		GLState().BindTexture(0, 0);
+	}
+	return m_Placeholder;
+}
+
+
+auto MC_OpenGL::TextureManager::Release() -> void
+{
+	// Waits for decodes still running when the futures are destroyed.
+	for (PendingUpload& pending : m_Pending)
+	{
+		glDeleteBuffers(1, &pending.pbo);
+		GLState().DeleteTexture(pending.texture);
+	}
+	m_Pending.clear();
+
+	for (auto& [state, sampler] : m_Samplers)
+		glDeleteSamplers(1, &sampler);
+	m_Samplers.clear();
+
+	GLState().DeleteTexture(m_Placeholder);
+	m_Placeholder = 0;
+}
+
+
+auto MC_OpenGL::TextureManager::Report(std::ostream& os) const -> void
+{
+	std::size_t resident = 0;
+	std::size_t residentBytes = 0;
+	for (const auto& [path, weak] : m_Images)
+	{
+		std::shared_ptr<const TextureImage> image = weak.lock();
+		if (image && image->resident)
+		{
+			os << "  " << image->path << ": " << image->width << 'x' << image->height << 'x' << image->channels
+				<< ", " << image->gpuBytes << " bytes, " << image.use_count() - 1 << " users\n";
+			++resident;
+			residentBytes += image->gpuBytes;
+		}
+	}
+
+	os << "Textures: " << resident << " resident (" << residentBytes << " bytes), " << m_Pending.size() << " streaming, "
+		<< m_Samplers.size() << " samplers, " << m_Decodes << " decodes, " << m_Hits << " cache hits\n";
+}
+
+
+auto MC_OpenGL::TextureManager::StartDecodes() -> void
+{
+	// Decoded chains wait in their futures until Update takes them, which also bounds the memory they hold.
+	std::size_t running = std::count_if(m_Pending.begin(), m_Pending.end(), [](const PendingUpload& pending) { return pending.decode.valid(); });
+	for (PendingUpload& pending : m_Pending)
+	{
+		if (running >= WorkerCount())
+			break;
+		if (pending.texture != 0 || pending.decode.valid())
+			continue;
+
+		pending.decode = std::async(std::launch::async, [path = pending.image->path, cacheDirectory = m_CacheDirectory]()
+		{
+			MipChain chain;
+			if (LoadCachedTexture(path, cacheDirectory, chain) != ErrorCode::NONE)
+				chain = MipChain();
+			return chain;
+		});
+		++running;
+	}
+}
+
+
+auto MC_OpenGL::TextureManager::Update(std::size_t budgetBytes) -> void
+{
+	auto it = m_Pending.begin();
+	while (it != m_Pending.end() && budgetBytes > 0)
+	{
+		PendingUpload& pending = *it;
+		TextureImage& image = *pending.image;
+		if (pending.texture == 0)
+		{
+			if (!pending.decode.valid() || pending.decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				++it;
+				continue;
+			}
+
+			pending.chain = pending.decode.get();
+			if (pending.chain.levels.empty())
+			{
+				std::cerr << "Error: failed to load texture " << image.path << '\n';
+				it = m_Pending.erase(it);
+				continue;
+			}
+
+			// Storage for every level now, contents row by row from the pixel buffer.
+			glGenTextures(1, &pending.texture);
+			GLState().BindForEdit(0, pending.texture);
+			for (std::size_t level = 0; level < pending.chain.levels.size(); ++level)
+				glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA, pending.chain.levels[level].width, pending.chain.levels[level].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(pending.chain.levels.size() - 1));
+
+			const MipLevel& last = pending.chain.levels.back();
+			glGenBuffers(1, &pending.pbo);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending.pbo);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, last.offset + last.size, nullptr, GL_STREAM_DRAW);
+		}
+
+		GLState().BindForEdit(0, pending.texture);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending.pbo);
+		while (budgetBytes > 0 && pending.level < pending.chain.levels.size())
+		{
+			const MipLevel& level = pending.chain.levels[pending.level];
+			const std::size_t rowBytes = static_cast<std::size_t>(level.width) * TextureCacheChannels;
+			const int rows = static_cast<int>(std::clamp<std::size_t>(budgetBytes / rowBytes, 1, level.height - pending.rowsUploaded));
+			const std::size_t offset = level.offset + pending.rowsUploaded * rowBytes;
+			const std::size_t size = rows * rowBytes;
+
+			// Every slice writes its own range of the buffer, so there is nothing to synchronize with.
+			// If the buffer cannot be mapped, or its contents were lost before the unmap, it holds no pixels for
+			// these rows; try them again next frame.
+			void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			if (mapped == nullptr)
+				break;
+			std::memcpy(mapped, pending.chain.Pixels() + offset, size);
+			if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+				break;
+
+			glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(pending.level), 0, pending.rowsUploaded, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(offset));
+
+			pending.rowsUploaded += rows;
+			budgetBytes -= std::min(budgetBytes, size);
+			if (pending.rowsUploaded == level.height)
+			{
+				++pending.level;
+				pending.rowsUploaded = 0;
+			}
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		GLState().BindTexture(0, 0);
+
+		if (pending.level < pending.chain.levels.size())
+			break;
+
+		glDeleteBuffers(1, &pending.pbo);
+
+		const MipLevel& base = pending.chain.levels.front();
+		const MipLevel& last = pending.chain.levels.back();
+		image.id = pending.texture;
+		image.resident = true;
+		image.width = base.width;
+		image.height = base.height;
+		image.channels = TextureCacheChannels;
+		image.gpuBytes = last.offset + last.size;
+		it = m_Pending.erase(it);
+	}
+
+	StartDecodes();
+}
+
+
+auto MC_OpenGL::TextureManager::Sampler(const SamplerState& samplerState) -> GLuint
+{
+	auto found = m_Samplers.find(samplerState);
+	if (found != m_Samplers.end())
+		return found->second;
+
+	GLuint sampler;
+	glGenSamplers(1, &sampler);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, samplerState.wrapS);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, samplerState.wrapT);
+	glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, samplerState.minFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, samplerState.magFilter);
+	m_Samplers.emplace(samplerState, sampler);
+	return sampler;
+}
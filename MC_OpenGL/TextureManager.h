@@ -0,0 +1,132 @@
+#pragma once
+
+
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "TextureCache.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	struct SamplerState
+	{
+		GLint	wrapS		= GL_REPEAT;
+		GLint	wrapT		= GL_REPEAT;
+		GLint	minFilter	= GL_LINEAR_MIPMAP_LINEAR;
+		GLint	magFilter	= GL_LINEAR;
+
+		auto operator<(const SamplerState& other) const -> bool
+		{
+			return std::tie(wrapS, wrapT, minFilter, magFilter) < std::tie(other.wrapS, other.wrapT, other.minFilter, other.magFilter);
+		}
+	};
+
+
+	/// <summary> An image on the GPU, with its full mip chain. Until the image is resident, id names a
+	/// 		  shared placeholder and the size is zero. Deleted with the last Texture that refers to it, so
+	/// 		  that must happen while the context is current. </summary>
+	struct TextureImage
+	{
+		GLuint		id			= 0;
+		bool		resident	= false;
+		int			width		= 0;
+		int			height		= 0;
+		int			channels	= 0;
+		std::size_t	gpuBytes	= 0;
+		std::string	path;
+	};
+
+
+	/// <summary> An image paired with the sampler object to read it with. Cheap to copy. </summary>
+	struct Texture
+	{
+		std::shared_ptr<const TextureImage>	image;
+		GLuint								sampler	= 0;
+
+		/// <summary> Bind image and sampler to texture unit GL_TEXTURE0 + unit. </summary>
+		auto Bind(GLuint unit) const -> void;
+
+		explicit operator bool() const
+		{
+			return image != nullptr;
+		}
+	};
+
+
+	/// <summary> Loads every image file once, however many drawables ask for it. Images are cached by path
+	/// 		  and sampler state lives in sampler objects, so the same image read with different wrapping or
+	/// 		  filtering still shares one upload. The manager only keeps weak references to images; sampler
+	/// 		  objects live until Release.
+	/// 		  Files are decoded on worker threads, at most WorkerCount() at once, and streamed to the GPU by
+	/// 		  Update through a pixel buffer, a few rows at a time, so neither startup nor any single frame
+	/// 		  pays for all of them. Decoded images and their mip chains are kept in an on-disk cache, see
+	/// 		  LoadCachedTexture. </summary>
+	class TextureManager
+	{
+	public:
+		TextureManager(const TextureManager&) = delete;
+		auto operator=(const TextureManager&) -> TextureManager& = delete;
+
+		static constexpr std::size_t defaultUploadBudget = 4 << 20;
+
+		TextureManager(const std::filesystem::path& cacheDirectory = R"(..\textures\cache)");
+
+		/// <summary> The image at path, flipped so that the first row is the bottom one. Returns at once; the
+		/// 		  texture shows a placeholder until Update has uploaded it, or for good if the file cannot be
+		/// 		  decoded. </summary>
+		auto Load(const std::string& path, const SamplerState& samplerState = SamplerState()) -> Texture;
+
+		/// <summary> Delete the sampler objects, the placeholder and any unfinished uploads. Call while the
+		/// 		  context is still current. </summary>
+		auto Release() -> void;
+
+		/// <summary> Print the resident images, their GPU size and how often the cache was hit. </summary>
+		auto Report(std::ostream& os) const -> void;
+
+		/// <summary> Upload up to budgetBytes of decoded pixels, at least one row unless the pixel
+		/// 		  buffer cannot be mapped, and make the images that are complete resident. Call once per
+		/// 		  frame. </summary>
+		auto Update(std::size_t budgetBytes = defaultUploadBudget) -> void;
+
+	private:
+		struct PendingUpload
+		{
+			std::shared_ptr<TextureImage>	image;
+			std::future<MipChain>			decode;			// Not valid while queued and once taken.
+			MipChain						chain;
+			GLuint							texture			= 0;	// Nonzero once decoding finished.
+			GLuint							pbo				= 0;
+			std::size_t						level			= 0;
+			int								rowsUploaded	= 0;	// In the current level.
+		};
+
+		auto Placeholder() -> GLuint;
+		auto Sampler(const SamplerState& samplerState) -> GLuint;
+
+		/// <summary> Start decoding queued images while fewer than WorkerCount() decodes are running. </summary>
+		auto StartDecodes() -> void;
+
+		std::filesystem::path												m_CacheDirectory;
+		std::unordered_map<std::string, std::weak_ptr<const TextureImage>>	m_Images;
+		std::map<SamplerState, GLuint>										m_Samplers;
+		std::vector<PendingUpload>											m_Pending;
+		GLuint																m_Placeholder	= 0;
+		std::size_t															m_Decodes	= 0;
+		std::size_t															m_Hits		= 0;
+	};
+
+
+}
@@ -0,0 +1,79 @@
+#include "TriangleStore.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Parallel.h"
+
+
+auto MC_OpenGL::TriangleStore::Assign(const std::vector<float>& vertices, std::size_t floatsPerVertex) -> void
+{
+	const std::size_t count = vertices.size() / (3 * floatsPerVertex);
+	for (auto& coord : m_Coords)
+		coord.resize(count);
+
+	const float* in = vertices.data();
+	ParallelFor(count, 1 << 16, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const float* vertex = in + (3 * i + corner) * floatsPerVertex;
+				m_Coords[3 * corner + 0][i] = vertex[0];
+				m_Coords[3 * corner + 1][i] = vertex[1];
+				m_Coords[3 * corner + 2][i] = vertex[2];
+			}
+		}
+	});
+}
+
+
+auto MC_OpenGL::TriangleStore::Permute(const std::vector<std::uint32_t>& order) -> void
+{
+	ParallelFor(m_Coords.size(), 1, [&](std::size_t begin, std::size_t end)
+	{
+		std::vector<float> permuted(order.size());
+		for (std::size_t c = begin; c < end; ++c)
+		{
+			for (std::size_t i = 0; i < order.size(); ++i)
+				permuted[i] = m_Coords[c][order[i]];
+			m_Coords[c].swap(permuted);
+		}
+	});
+}
+
+
+auto MC_OpenGL::TriangleStore::Bounds(glm::vec3& min, glm::vec3& max) const -> void
+{
+	min = glm::vec3(std::numeric_limits<float>::max());
+	max = glm::vec3(std::numeric_limits<float>::lowest());
+	if (Size() == 0)
+		return;
+
+	for (int corner = 0; corner < 3; ++corner)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const auto& coord = m_Coords[3 * corner + axis];
+			auto [lo, hi] = std::minmax_element(coord.begin(), coord.end());
+			min[axis] = std::min(min[axis], *lo);
+			max[axis] = std::max(max[axis], *hi);
+		}
+	}
+}
+
+
+auto MC_OpenGL::TriangleStore::Size() const -> std::size_t
+{
+	return m_Coords[0].size();
+}
+
+
+auto MC_OpenGL::TriangleStore::View() const -> TriangleView
+{
+	TriangleView view;
+	for (std::size_t c = 0; c < m_Coords.size(); ++c)
+		view.coords[c] = std::span<const float>(m_Coords[c]);
+	return view;
+}
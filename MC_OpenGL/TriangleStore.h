@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm.hpp>
+
+#include <Mathematics/Triangle.h>
+
+
+namespace MC_OpenGL
+{
+
+
+	/// <summary> Non-owning view of a TriangleStore. Valid until the store is modified or destroyed. </summary>
+	struct TriangleView
+	{
+		// One contiguous array per corner coordinate: v0.x, v0.y, v0.z, v1.x, ..., v2.z.
+		std::array<std::span<const float>, 9> coords;
+
+		auto Size() const -> std::size_t
+		{
+			return coords[0].size();
+		}
+
+		auto Vertex(std::size_t triangle, int corner) const -> glm::vec3
+		{
+			return glm::vec3(coords[3 * corner][triangle], coords[3 * corner + 1][triangle], coords[3 * corner + 2][triangle]);
+		}
+
+		auto Triangle(std::size_t triangle) const -> gte::Triangle3<float>
+		{
+			return gte::Triangle3<float>(
+				gte::Vector3<float>({ coords[0][triangle], coords[1][triangle], coords[2][triangle] }),
+				gte::Vector3<float>({ coords[3][triangle], coords[4][triangle], coords[5][triangle] }),
+				gte::Vector3<float>({ coords[6][triangle], coords[7][triangle], coords[8][triangle] }));
+		}
+	};
+
+
+	/// <summary> Triangle positions stored as a structure of arrays for streaming queries. </summary>
+	class TriangleStore
+	{
+	public:
+		/// <summary> Fill the store from a non-indexed interleaved vertex buffer, three vertices per triangle
+		/// 		  with the position at the start of each vertex. </summary>
+		auto Assign(const std::vector<float>& vertices, std::size_t floatsPerVertex) -> void;
+
+		/// <summary> Reorder the triangles so that triangle i becomes the old triangle order[i]. </summary>
+		auto Permute(const std::vector<std::uint32_t>& order) -> void;
+
+		auto Bounds(glm::vec3& min, glm::vec3& max) const -> void;
+		auto Size() const -> std::size_t;
+		auto View() const -> TriangleView;
+
+	private:
+		std::array<std::vector<float>, 9> m_Coords;
+	};
+
+
+}
@@ -0,0 +1,69 @@
+#include "Unprojector.h"
+
+
+auto MC_OpenGL::Unprojector::InverseViewProjection() const -> const glm::mat4&
+{
+	return m_InverseViewProjection;
+}
+
+
+auto MC_OpenGL::Unprojector::Ray(double x, double y) const -> WorldRay
+{
+	WorldRay ray;
+	ray.origin = m_Origin + static_cast<float>(x) * m_OriginStepX + static_cast<float>(y) * m_OriginStepY;
+	ray.direction = m_Direction;
+	return ray;
+}
+
+
+auto MC_OpenGL::Unprojector::Rays(const glm::vec2* points, std::size_t count, WorldRay* rays) const -> void
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		rays[i].origin = m_Origin + points[i].x * m_OriginStepX + points[i].y * m_OriginStepY;
+		rays[i].direction = m_Direction;
+	}
+}
+
+
+auto MC_OpenGL::Unprojector::Update(const Camera& camera, const ProjectionOrthographic& projection, float windowWidth, float windowHeight) -> void
+{
+	if (camera.Version() == m_CameraVersion && projection.Version() == m_ProjectionVersion && windowWidth == m_WindowWidth && windowHeight == m_WindowHeight)
+		return;
+
+	m_CameraVersion = camera.Version();
+	m_ProjectionVersion = projection.Version();
+	m_WindowWidth = windowWidth;
+	m_WindowHeight = windowHeight;
+
+	m_ViewProjection = projection.ProjectionMatrix() * camera.ViewMatrix();
+	m_InverseViewProjection = camera.InverseViewMatrix() * projection.InverseProjectionMatrix();
+
+	// Window x runs right and y down over [0, size); NDC x runs right and y up over [-1, 1]. Rays start on
+	// the near plane, NDC z = -1, and run towards the far plane.
+	const float ndcPerX = 2.f / windowWidth;
+	const float ndcPerY = -2.f / windowHeight;
+	const glm::vec4 ndcAtOrigin(-1.f, 1.f, -1.f, 1.f);
+
+	m_Origin = glm::vec3(m_InverseViewProjection * ndcAtOrigin);
+	m_OriginStepX = ndcPerX * glm::vec3(m_InverseViewProjection[0]);
+	m_OriginStepY = ndcPerY * glm::vec3(m_InverseViewProjection[1]);
+	m_Direction = glm::normalize(glm::vec3(m_InverseViewProjection[2]));
+
+	const glm::mat4& inverseProjection = projection.InverseProjectionMatrix();
+	const glm::vec4 viewOrigin = inverseProjection * ndcAtOrigin;
+	m_ViewOrigin = glm::vec2(viewOrigin.x, viewOrigin.y);
+	m_ViewStep = glm::vec2(ndcPerX * inverseProjection[0][0], ndcPerY * inverseProjection[1][1]);
+}
+
+
+auto MC_OpenGL::Unprojector::ViewPoint(double x, double y) const -> glm::vec2
+{
+	return m_ViewOrigin + glm::vec2(static_cast<float>(x) * m_ViewStep.x, static_cast<float>(y) * m_ViewStep.y);
+}
+
+
+auto MC_OpenGL::Unprojector::ViewProjection() const -> const glm::mat4&
+{
+	return m_ViewProjection;
+}
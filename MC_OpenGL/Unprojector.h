@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm.hpp>
+
+#include "Camera.h"
+#include "ProjectionOrthographic.h"
+
+
+namespace MC_OpenGL
+{
+
+
+	struct WorldRay
+	{
+		glm::vec3	origin		= glm::vec3(0.f);	// On the near plane.
+		glm::vec3	direction	= glm::vec3(0.f, 0.f, -1.f);	// Unit length, into the screen.
+	};
+
+
+	/// <summary> Maps window coordinates, as GLFW reports the cursor, to world space rays and view space
+	/// 		  points for picking, zooming to the cursor and snapping. The orthographic projection makes the
+	/// 		  map affine, so after Update every ray costs two multiply-adds per component and no matrix
+	/// 		  work. </summary>
+	class Unprojector
+	{
+	public:
+		/// <summary> Bring the cached matrices up to date with camera, projection and the window size. Only
+		/// 		  does work when one of them changed since the last call. </summary>
+		auto Update(const Camera& camera, const ProjectionOrthographic& projection, float windowWidth, float windowHeight) -> void;
+
+		auto InverseViewProjection() const -> const glm::mat4&;
+
+		/// <summary> The ray through window point (x, y). </summary>
+		auto Ray(double x, double y) const -> WorldRay;
+
+		/// <summary> The rays through count window points, in order. </summary>
+		auto Rays(const glm::vec2* points, std::size_t count, WorldRay* rays) const -> void;
+
+		/// <summary> View space x and y of window point (x, y). </summary>
+		auto ViewPoint(double x, double y) const -> glm::vec2;
+		auto ViewProjection() const -> const glm::mat4&;
+
+	private:
+		std::uint64_t	m_CameraVersion			= ~std::uint64_t(0);
+		std::uint64_t	m_ProjectionVersion		= ~std::uint64_t(0);
+		float			m_WindowWidth			= 0.f;
+		float			m_WindowHeight			= 0.f;
+		glm::mat4		m_ViewProjection		= glm::mat4(1.f);
+		glm::mat4		m_InverseViewProjection	= glm::mat4(1.f);
+
+		// Ray origin at window point (0, 0) and its change per window unit along x and y.
+		glm::vec3		m_Origin				= glm::vec3(0.f);
+		glm::vec3		m_OriginStepX			= glm::vec3(0.f);
+		glm::vec3		m_OriginStepY			= glm::vec3(0.f);
+		glm::vec3		m_Direction				= glm::vec3(0.f, 0.f, -1.f);
+
+		// The same for view space x and y.
+		glm::vec2		m_ViewOrigin			= glm::vec2(0.f);
+		glm::vec2		m_ViewStep				= glm::vec2(0.f);
+	};
+
+
+}
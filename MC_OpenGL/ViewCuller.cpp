@@ -0,0 +1,87 @@
+#include "ViewCuller.h"
+
+#include <cmath>
+
+#include <emmintrin.h>
+
+#include "Drawable.h"
+#include "Profiler.h"
+
+
+auto MC_OpenGL::ViewCuller::Cull(const std::vector<Drawable*>& drawables, const glm::mat4& view, const glm::vec3& volumeMin,
+	const glm::vec3& volumeMax, std::vector<Drawable*>& visible) -> void
+{
+	MC_PROFILE_ZONE("ViewCuller::Cull");
+	const std::size_t count = drawables.size();
+	const std::size_t padded = (count + 3) & ~std::size_t(3);
+	for (std::vector<float>& coordinate : m_Bounds)
+		coordinate.assign(padded, 0.f);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+		drawables[i]->WorldBounds(min, max);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			m_Bounds[axis][i] = 0.5f * (min[axis] + max[axis]);
+			m_Bounds[3 + axis][i] = 0.5f * (max[axis] - min[axis]);
+		}
+	}
+
+	// Rows of the view matrix, splatted; glm stores it by column.
+	__m128 center[3][4];
+	__m128 extent[3][3];
+	for (int row = 0; row < 3; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+			center[row][column] = _mm_set1_ps(view[column][row]);
+		for (int column = 0; column < 3; ++column)
+			extent[row][column] = _mm_set1_ps(std::fabs(view[column][row]));
+	}
+	const __m128 lower[3] = { _mm_set1_ps(volumeMin.x), _mm_set1_ps(volumeMin.y), _mm_set1_ps(volumeMin.z) };
+	const __m128 upper[3] = { _mm_set1_ps(volumeMax.x), _mm_set1_ps(volumeMax.y), _mm_set1_ps(volumeMax.z) };
+
+	visible.clear();
+	for (std::size_t i = 0; i < padded; i += 4)
+	{
+		const __m128 cx = _mm_loadu_ps(&m_Bounds[0][i]);
+		const __m128 cy = _mm_loadu_ps(&m_Bounds[1][i]);
+		const __m128 cz = _mm_loadu_ps(&m_Bounds[2][i]);
+		const __m128 ex = _mm_loadu_ps(&m_Bounds[3][i]);
+		const __m128 ey = _mm_loadu_ps(&m_Bounds[4][i]);
+		const __m128 ez = _mm_loadu_ps(&m_Bounds[5][i]);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int row = 0; row < 3; ++row)
+		{
+			const __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(center[row][0], cx), _mm_mul_ps(center[row][1], cy)),
+				_mm_add_ps(_mm_mul_ps(center[row][2], cz), center[row][3]));
+			const __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extent[row][0], ex), _mm_mul_ps(extent[row][1], ey)), _mm_mul_ps(extent[row][2], ez));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(c, e), lower[row]));
+			inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(c, e), upper[row]));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (std::size_t lane = 0; mask != 0 && i + lane < count; ++lane, mask >>= 1)
+		{
+			if (mask & 1)
+				visible.push_back(drawables[i + lane]);
+		}
+	}
+
+	m_Stats.visible = visible.size();
+	m_Stats.culled = count - visible.size();
+}
+
+
+auto MC_OpenGL::ViewCuller::Report(std::ostream& os) const -> void
+{
+	os << "Culling: " << m_Stats.visible << " visible, " << m_Stats.culled << " culled\n";
+}
+
+
+auto MC_OpenGL::ViewCuller::Stats() const -> const CullStats&
+{
+	return m_Stats;
+}
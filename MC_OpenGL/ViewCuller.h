@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <glm.hpp>
+
+
+namespace MC_OpenGL
+{
+
+
+	class Drawable;
+
+
+	struct CullStats
+	{
+		std::size_t		visible		= 0;
+		std::size_t		culled		= 0;
+	};
+
+
+	/// <summary> Finds the drawables whose world bounds reach into an orthographic view volume. The bounds
+	/// 		  are gathered into structure of arrays layout and tested four at a time with SSE: the center of
+	/// 		  each box goes to view space and its half extents through the absolute view matrix, which gives
+	/// 		  the view space box around the world box. That box is never smaller than the drawable, so
+	/// 		  nothing visible is culled. </summary>
+	class ViewCuller
+	{
+	public:
+		ViewCuller() = default;
+		ViewCuller(const ViewCuller&) = delete;
+		auto operator=(const ViewCuller&) -> ViewCuller& = delete;
+
+		/// <summary> Replace visible with the drawables overlapping [volumeMin, volumeMax] in the space view
+		/// 		  maps world space to, in their original order. </summary>
+		auto Cull(const std::vector<Drawable*>& drawables, const glm::mat4& view, const glm::vec3& volumeMin,
+			const glm::vec3& volumeMax, std::vector<Drawable*>& visible) -> void;
+
+		/// <summary> Print the counts of the last Cull. </summary>
+		auto Report(std::ostream& os) const -> void;
+		auto Stats() const -> const CullStats&;
+
+	private:
+		// Box centers and half extents, one array per coordinate, padded to a multiple of four.
+		std::vector<float>	m_Bounds[6];
+		CullStats			m_Stats;
+	};
+
+
+}
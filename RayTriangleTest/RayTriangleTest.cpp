@@ -0,0 +1,404 @@
+// Cross-checks the SIMD ray-triangle kernels of MC_OpenGL against GTE's ray-triangle query, and every SIMD
+// level against the scalar kernel, on random and degenerate rays and triangles.
+//
+// Usage: RayTriangleTest [seed]
+// Prints a line per SIMD level and returns 0 when everything matches. Levels the CPU does not support are
+// reported as skipped.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm.hpp>
+
+#include <Mathematics/IntrRay3Triangle3.h>
+
+#include "../MC_OpenGL/RayTriangle.h"
+#include "../MC_OpenGL/TriangleStore.h"
+
+
+namespace {
+
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
+
+struct Hit
+{
+	bool			hit			= false;
+	float			t			= 0.f;
+	std::uint32_t	triangle	= 0;
+};
+
+
+struct Counts
+{
+	std::size_t		pairs		= 0;
+	std::size_t		hits		= 0;
+	std::size_t		ambiguous	= 0;
+	std::size_t		failures	= 0;
+};
+
+
+// How the double precision reference sees a ray-triangle pair. Single precision can only resolve the hit
+// to within a few ulps of the coordinates involved, which is a lot for small triangles, far away origins and
+// glancing rays; within that, a hit or miss may go either way and t and the barycentrics are compared loosely.
+struct Reference
+{
+	bool	zeroArea		= false;	// Exactly zero normal or direction: every query has to miss.
+	bool	grazing			= false;	// Nearly parallel to the plane: nothing is compared.
+	bool	onBoundary		= false;	// Within baryTolerance of an edge or tTolerance of t = 0.
+	double	tTolerance		= 0.0;
+	double	baryTolerance	= 0.0;
+};
+
+
+const char* const levelNames[] = { "Scalar", "SSE4.1", "AVX2", "AVX-512" };
+
+// The widest SIMD level's lane count.
+constexpr std::size_t laneCount = 16;
+
+
+auto Classify(const Ray& ray, const glm::vec3 (&v)[3]) -> Reference
+{
+	Reference reference;
+	const glm::dvec3 v0(v[0]);
+	const glm::dvec3 e1 = glm::dvec3(v[1]) - v0;
+	const glm::dvec3 e2 = glm::dvec3(v[2]) - v0;
+	const glm::dvec3 d(ray.direction);
+	const glm::dvec3 n = glm::cross(e1, e2);
+
+	const double nn = glm::dot(n, n);
+	if (nn == 0.0 || glm::dot(d, d) == 0.0)
+	{
+		reference.zeroArea = true;
+		return reference;
+	}
+
+	const double lengthD = std::sqrt(glm::dot(d, d));
+	const double cosine = std::abs(glm::dot(d, n)) / (lengthD * std::sqrt(nn));
+	if (cosine < 1e-3)
+	{
+		reference.grazing = true;
+		return reference;
+	}
+
+	const glm::dvec3 s = glm::dvec3(ray.origin) - v0;
+	const double t = -glm::dot(s, n) / glm::dot(d, n);
+	const glm::dvec3 q = s + t * d;
+	const double b1 = glm::dot(glm::cross(q, e2), n) / nn;
+	const double b2 = glm::dot(glm::cross(e1, q), n) / nn;
+	const double b0 = 1.0 - b1 - b2;
+
+	// The height over the longest edge is how far a position error moves the barycentrics.
+	const glm::dvec3 e3 = e2 - e1;
+	const double longest = std::sqrt(std::max(glm::dot(e1, e1), std::max(glm::dot(e2, e2), glm::dot(e3, e3))));
+	const double height = std::sqrt(nn) / longest;
+	const double positionError = 1e-6 * (std::sqrt(glm::dot(s, s)) + std::abs(t) * lengthD + longest);
+	reference.tTolerance = 1e-5 * std::abs(t) + positionError / (lengthD * cosine);
+	reference.baryTolerance = 1e-5 + positionError / (height * cosine);
+
+	const double nearest = std::min(b0, std::min(b1, b2));
+	reference.onBoundary = std::abs(nearest) < reference.baryTolerance || std::abs(t) < reference.tTolerance;
+	return reference;
+}
+
+
+// Barycentric coordinates of the point at t along the ray, in double precision.
+auto Barycentrics(const Ray& ray, float t, const glm::vec3 (&v)[3]) -> std::array<double, 3>
+{
+	const glm::dvec3 v0(v[0]);
+	const glm::dvec3 e1 = glm::dvec3(v[1]) - v0;
+	const glm::dvec3 e2 = glm::dvec3(v[2]) - v0;
+	const glm::dvec3 n = glm::cross(e1, e2);
+	const double nn = glm::dot(n, n);
+
+	const glm::dvec3 p = glm::dvec3(ray.origin) + static_cast<double>(t) * glm::dvec3(ray.direction);
+	const glm::dvec3 q = p - v0;
+	const double b1 = glm::dot(glm::cross(q, e2), n) / nn;
+	const double b2 = glm::dot(glm::cross(e1, q), n) / nn;
+	return { 1.0 - b1 - b2, b1, b2 };
+}
+
+
+auto ToGte(const glm::vec3& v) -> gte::Vector3<float>
+{
+	return gte::Vector3<float>({ v.x, v.y, v.z });
+}
+
+
+auto RandomTriangles(std::mt19937& random, std::size_t count, std::vector<glm::vec3>& corners) -> void
+{
+	std::uniform_real_distribution<float> coordinate(-1.f, 1.f);
+	for (std::size_t i = 0; i < 3 * count; ++i)
+		corners.emplace_back(coordinate(random), coordinate(random), coordinate(random));
+}
+
+
+auto DegenerateTriangles(std::vector<glm::vec3>& corners) -> void
+{
+	const glm::vec3 degenerate[][3] =
+	{
+		{ { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } },				// Axis aligned, for exact edge and vertex hits.
+		{ { 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 1.f, 0.f, 0.f } },				// The same, wound the other way.
+		{ { 0.2f, 0.3f, 0.4f }, { 0.2f, 0.3f, 0.4f }, { -0.5f, 0.1f, 0.9f } },	// Two corners the same.
+		{ { 0.3f, 0.3f, 0.3f }, { 0.3f, 0.3f, 0.3f }, { 0.3f, 0.3f, 0.3f } },	// A point.
+		{ { 0.f, 0.f, 0.f }, { 0.5f, 0.5f, 0.5f }, { 1.f, 1.f, 1.f } },			// Collinear.
+		{ { 0.1f, 0.1f, 0.1f }, { 0.1f + 1e-6f, 0.1f, 0.1f }, { 0.1f, 0.1f + 1e-6f, 0.1f } },	// Tiny.
+		{ { -1e4f, -1e4f, 0.5f }, { 1e4f, -1e4f, 0.5f }, { 0.f, 1e4f, 0.5f } },	// Huge.
+		{ { -1.f, 0.f, -1.f }, { 1.f, 0.f, -1.f }, { 0.f, 0.f, 1.f } },			// In the plane y = 0.
+	};
+
+	for (const auto& triangle : degenerate)
+		corners.insert(corners.end(), std::begin(triangle), std::end(triangle));
+}
+
+
+auto RandomRays(std::mt19937& random, const std::vector<glm::vec3>& corners, std::size_t count, std::vector<Ray>& rays) -> void
+{
+	std::uniform_real_distribution<float> coordinate(-3.f, 3.f);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	std::uniform_int_distribution<std::size_t> pick(0, corners.size() / 3 - 1);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const glm::vec3 origin(coordinate(random), coordinate(random), coordinate(random));
+		if (i % 2 == 0)
+		{
+			rays.push_back(Ray{ origin, glm::vec3(coordinate(random), coordinate(random), coordinate(random)) });
+			continue;
+		}
+
+		// Aim at a random point of a random triangle, so that about half the rays hit something.
+		const std::size_t triangle = pick(random);
+		float a = unit(random);
+		float b = unit(random);
+		if (a + b > 1.f)
+		{
+			a = 1.f - a;
+			b = 1.f - b;
+		}
+		const glm::vec3& v0 = corners[3 * triangle];
+		const glm::vec3 target = v0 + a * (corners[3 * triangle + 1] - v0) + b * (corners[3 * triangle + 2] - v0);
+		rays.push_back(Ray{ origin, target - origin });
+	}
+}
+
+
+auto DegenerateRays(std::vector<Ray>& rays) -> void
+{
+	const Ray degenerate[] =
+	{
+		{ { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f } },			// Through a vertex of the axis aligned triangles.
+		{ { 0.5f, 0.f, 1.f }, { 0.f, 0.f, -1.f } },			// Through an edge.
+		{ { 0.5f, 0.5f, 1.f }, { 0.f, 0.f, -1.f } },		// Through the hypotenuse.
+		{ { 0.25f, 0.25f, 0.f }, { 0.f, 0.f, -1.f } },		// Starting on the triangle, t = 0.
+		{ { 0.25f, 0.25f, -1.f }, { 0.f, 0.f, -1.f } },		// Pointing away.
+		{ { -1.f, 0.2f, 0.f }, { 1.f, 0.f, 0.f } },			// In the plane of the triangle.
+		{ { 0.f, 2.f, 0.f }, { 0.f, -1.f, 0.f } },			// Along the plane y = 0 triangle's normal.
+		{ { 0.25f, 0.25f, 1.f }, { 0.f, 0.f, -10.f } },		// Direction not of unit length.
+		{ { 0.25f, 0.25f, 1.f }, { 0.f, 0.f, -1e-20f } },	// Direction nearly zero.
+		{ { 0.25f, 0.25f, 1.f }, { 0.f, 0.f, 0.f } },		// Direction zero.
+		{ { 0.1f, 0.1f, 1.f }, { 1e-7f, 1e-7f, -1.f } },	// Towards the tiny triangle.
+	};
+
+	rays.insert(rays.end(), std::begin(degenerate), std::end(degenerate));
+}
+
+
+// Compare the kernel with GTE on every ray-triangle pair, and keep the kernel's results for the comparison
+// between levels. lanes holds every triangle of view laneCount times in a row, so that each pair fills whole
+// SIMD registers instead of falling through to the scalar tail.
+auto CheckAgainstGte(const MC_OpenGL::TriangleView& view, const MC_OpenGL::TriangleView& lanes, const std::vector<Ray>& rays,
+	const std::string& level, Counts& counts, std::vector<Hit>& results) -> void
+{
+	gte::FIQuery<float, gte::Ray3<float>, gte::Triangle3<float> > query;
+	results.clear();
+	for (std::size_t r = 0; r < rays.size(); ++r)
+	{
+		const Ray& ray = rays[r];
+		const gte::Ray3<float> gteRay(ToGte(ray.origin), ToGte(ray.direction));
+		for (std::size_t i = 0; i < view.Size(); ++i)
+		{
+			Hit hit;
+			hit.t = std::numeric_limits<float>::infinity();
+			hit.hit = MC_OpenGL::IntersectRayTriangles(lanes, laneCount * i, laneCount, ray.origin, ray.direction, hit.t, hit.triangle);
+			results.push_back(hit);
+
+			const glm::vec3 v[3] = { view.Vertex(i, 0), view.Vertex(i, 1), view.Vertex(i, 2) };
+			const auto expected = query(gteRay, view.Triangle(i));
+			const Reference reference = Classify(ray, v);
+
+			++counts.pairs;
+			counts.hits += hit.hit ? 1 : 0;
+
+			std::string problem;
+			if (hit.hit && hit.triangle != laneCount * i)
+				problem = "tie between lanes not resolved to the first";
+			else if (reference.zeroArea)
+			{
+				if (hit.hit || expected.intersect)
+					problem = "zero area triangle or zero direction reported as hit";
+			}
+			else if (reference.grazing)
+			{
+				++counts.ambiguous;
+			}
+			else if (hit.hit != expected.intersect)
+			{
+				if (reference.onBoundary)
+					++counts.ambiguous;
+				else
+					problem = hit.hit ? "hit where GTE misses" : "miss where GTE hits";
+			}
+			else if (hit.hit)
+			{
+				const std::array<double, 3> bary = Barycentrics(ray, hit.t, v);
+				if (std::abs(hit.t - expected.parameter) > 2.0 * reference.tTolerance)
+					problem = "t " + std::to_string(hit.t) + " where GTE has " + std::to_string(expected.parameter);
+				for (int k = 0; k < 3 && problem.empty(); ++k)
+				{
+					if (std::abs(bary[k] - static_cast<double>(expected.triangleBary[k])) > 2.0 * reference.baryTolerance)
+						problem = "barycentric " + std::to_string(k) + " is " + std::to_string(bary[k]) + " where GTE has " + std::to_string(expected.triangleBary[k]);
+				}
+			}
+
+			if (!problem.empty())
+			{
+				++counts.failures;
+				if (counts.failures <= 10)
+					std::cerr << level << ": ray " << r << ", triangle " << i << ": " << problem << '\n';
+			}
+		}
+	}
+}
+
+
+// Blocks of triangles, leaf sized and larger, have to report the closest of their per-triangle hits, ties
+// going to the lower index. This covers the reduction across lanes and the scalar tails of the SIMD kernels.
+auto CheckBlocks(const MC_OpenGL::TriangleView& view, const std::vector<Ray>& rays, const std::vector<Hit>& single,
+	const std::string& level, Counts& counts) -> void
+{
+	const std::size_t numTriangles = view.Size();
+	for (std::size_t r = 0; r < rays.size(); ++r)
+	{
+		for (std::size_t count : { std::size_t(1), std::size_t(3), std::size_t(8), std::size_t(13), std::size_t(16), std::size_t(37), numTriangles })
+		{
+			for (std::size_t first = 0; first + count <= numTriangles; first += std::max<std::size_t>(count, 29))
+			{
+				Hit expected;
+				expected.t = std::numeric_limits<float>::infinity();
+				for (std::size_t i = first; i < first + count; ++i)
+				{
+					const Hit& hit = single[r * numTriangles + i];
+					if (hit.hit && hit.t < expected.t)
+					{
+						expected.hit = true;
+						expected.t = hit.t;
+						expected.triangle = static_cast<std::uint32_t>(i);
+					}
+				}
+
+				Hit block;
+				block.t = std::numeric_limits<float>::infinity();
+				block.hit = MC_OpenGL::IntersectRayTriangles(view, first, count, rays[r].origin, rays[r].direction, block.t, block.triangle);
+				if (block.hit != expected.hit || (block.hit && (block.t != expected.t || block.triangle != expected.triangle)))
+				{
+					++counts.failures;
+					if (counts.failures <= 10)
+						std::cerr << level << ": ray " << r << ", triangles [" << first << ", " << first + count << "): closest hit differs from the single triangle results\n";
+				}
+			}
+		}
+	}
+}
+
+
+}
+
+
+int main(int argc, char* argv[])
+{
+	const unsigned int seed = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 1u;
+	std::mt19937 random(seed);
+
+	std::vector<glm::vec3> corners;
+	RandomTriangles(random, 256, corners);
+	DegenerateTriangles(corners);
+
+	std::vector<Ray> rays;
+	RandomRays(random, corners, 512, rays);
+	DegenerateRays(rays);
+
+	std::vector<float> vertices;
+	std::vector<float> laneVertices;
+	for (std::size_t i = 0; i < corners.size(); i += 3)
+	{
+		for (std::size_t corner = i; corner < i + 3; ++corner)
+			vertices.insert(vertices.end(), { corners[corner].x, corners[corner].y, corners[corner].z });
+		for (std::size_t lane = 0; lane < laneCount; ++lane)
+			laneVertices.insert(laneVertices.end(), vertices.end() - 9, vertices.end());
+	}
+
+	MC_OpenGL::TriangleStore store;
+	store.Assign(vertices, 3);
+	const MC_OpenGL::TriangleView view = store.View();
+
+	MC_OpenGL::TriangleStore laneStore;
+	laneStore.Assign(laneVertices, 3);
+	const MC_OpenGL::TriangleView lanes = laneStore.View();
+
+	const MC_OpenGL::SimdLevel supported = MC_OpenGL::DetectSimdLevel();
+	std::vector<Hit> scalarResults;
+	std::vector<Hit> results;
+	bool failed = false;
+	for (MC_OpenGL::SimdLevel level : { MC_OpenGL::SimdLevel::Scalar, MC_OpenGL::SimdLevel::Sse41, MC_OpenGL::SimdLevel::Avx2, MC_OpenGL::SimdLevel::Avx512 })
+	{
+		const std::string name = levelNames[static_cast<int>(level)];
+		if (level > supported)
+		{
+			std::cout << name << ": skipped, not supported by this CPU\n";
+			continue;
+		}
+
+		MC_OpenGL::SetSimdLevel(level);
+		Counts counts;
+		CheckAgainstGte(view, lanes, rays, name, counts, results);
+		CheckBlocks(view, rays, results, name, counts);
+
+		if (level == MC_OpenGL::SimdLevel::Scalar)
+		{
+			scalarResults = results;
+		}
+		else
+		{
+			// The SIMD kernels promise bit-identical results, not just close ones.
+			for (std::size_t i = 0; i < results.size(); ++i)
+			{
+				if (results[i].hit != scalarResults[i].hit || (results[i].hit && results[i].t != scalarResults[i].t))
+				{
+					++counts.failures;
+					if (counts.failures <= 10)
+						std::cerr << name << ": ray " << i / view.Size() << ", triangle " << i % view.Size() << ": differs from the scalar kernel\n";
+				}
+			}
+		}
+
+		std::cout << name << ": " << counts.pairs << " ray-triangle pairs, " << counts.hits << " hits, "
+			<< counts.ambiguous << " too close to call, " << counts.failures << " mismatches\n";
+		failed = failed || counts.failures > 0;
+	}
+
+	std::cout << (failed ? "FAILED" : "Passed") << " (seed " << seed << ")\n";
+	return failed ? 1 : 0;
+}
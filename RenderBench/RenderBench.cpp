@@ -0,0 +1,244 @@
+// Renders a scene of cubes and STL meshes into a RecordingDevice, without a window or a GL context, and
+// checks what reached the device: one draw per drawable, no more program and vertex array binds than the
+// sorted render queue needs, and the uniform and clear values that were passed. Also times the CPU side of
+// a frame.
+//
+// Usage: RenderBench [frames]
+// Prints the recorded counts of the last frame and the mean frame time, and returns 0 when every check
+// passes.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+
+#include "../MC_OpenGL/Drawable.h"
+#include "../MC_OpenGL/FrameData.h"
+#include "../MC_OpenGL/GLState.h"
+#include "../MC_OpenGL/GeometryRegistry.h"
+#include "../MC_OpenGL/RecordingDevice.h"
+#include "../MC_OpenGL/RenderDevice.h"
+#include "../MC_OpenGL/RenderQueue.h"
+#include "../MC_OpenGL/Shader.h"
+
+
+namespace {
+
+
+constexpr int		gridSize		= 32;	// gridSize^2 cubes.
+constexpr int		meshCopies		= 8;	// Drawables sharing the one STL mesh.
+const glm::vec4		clearColor		= glm::vec4(0.1f, 0.2f, 0.3f, 1.f);
+const glm::vec3		highlightColor	= glm::vec3(1.f, 1.f, 0.f);
+
+
+// A made up program with the uniforms every drawable resolves; no GL program has to exist.
+auto BenchShader(GLuint programId) -> MC_OpenGL::Shader
+{
+	return MC_OpenGL::Shader(programId, { { "model", 0, GL_FLOAT_MAT4, 1 }, { "objectColor", 1, GL_FLOAT_VEC3, 1 } });
+}
+
+
+// Binary STL of the box from min to max, two facets per side.
+auto WriteBoxStl(const std::filesystem::path& filename, const glm::vec3& min, const glm::vec3& max) -> bool
+{
+	const glm::vec3 c[8] =
+	{
+		{ min.x, min.y, min.z }, { max.x, min.y, min.z }, { max.x, max.y, min.z }, { min.x, max.y, min.z },
+		{ min.x, min.y, max.z }, { max.x, min.y, max.z }, { max.x, max.y, max.z }, { min.x, max.y, max.z }
+	};
+	const int facets[12][3] =
+	{
+		{ 0, 2, 1 }, { 0, 3, 2 }, { 4, 5, 6 }, { 4, 6, 7 }, { 0, 1, 5 }, { 0, 5, 4 },
+		{ 3, 6, 2 }, { 3, 7, 6 }, { 0, 4, 7 }, { 0, 7, 3 }, { 1, 2, 6 }, { 1, 6, 5 }
+	};
+
+	std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+	const char header[80] = "RenderBench box";
+	const std::uint32_t count = 12;
+	ofs.write(header, sizeof(header));
+	ofs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (const auto& facet : facets)
+	{
+		const glm::vec3 normal = glm::normalize(glm::cross(c[facet[1]] - c[facet[0]], c[facet[2]] - c[facet[0]]));
+		ofs.write(reinterpret_cast<const char*>(&normal), sizeof(normal));
+		for (int corner : facet)
+			ofs.write(reinterpret_cast<const char*>(&c[corner]), sizeof(glm::vec3));
+		const std::uint16_t attributes = 0;
+		ofs.write(reinterpret_cast<const char*>(&attributes), sizeof(attributes));
+	}
+	return static_cast<bool>(ofs);
+}
+
+
+// One frame the way Main.cpp renders it, minus picking and the cube batch.
+auto RenderFrame(const std::vector<MC_OpenGL::Drawable*>& drawables, MC_OpenGL::FrameUniformBuffer& frameUniforms, const MC_OpenGL::FrameData& frameData, MC_OpenGL::RenderQueue& queue) -> void
+{
+	frameUniforms.Update(frameData);
+
+	MC_OpenGL::Device().Viewport(0, 0, 800, 600);
+	MC_OpenGL::Device().ClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+	MC_OpenGL::Device().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	queue.Clear();
+	for (const MC_OpenGL::Drawable* drawable : drawables)
+	{
+		const bool highlight = drawable->GetHover() || drawable->GetSelected();
+		glm::vec3 center;
+		float radius;
+		drawable->BoundingSphere(center, radius);
+		const float depth = -(frameData.view * glm::vec4(center, 1.f)).z;
+		queue.Add(highlight ? MC_OpenGL::RenderPass::Highlight : MC_OpenGL::RenderPass::Opaque, drawable, highlight ? highlightColor : drawable->GetColor(), depth);
+	}
+	queue.Sort();
+
+	const MC_OpenGL::RenderQueue::DrawFn drawItem = [](const MC_OpenGL::RenderItem& item) { item.drawable->Draw(item.color); };
+	queue.Submit(MC_OpenGL::RenderPass::Opaque, drawItem);
+	queue.Submit(MC_OpenGL::RenderPass::Highlight, drawItem);
+	MC_OpenGL::GLState().EndFrame();
+}
+
+
+auto Check(bool condition, const std::string& what, int& failures) -> void
+{
+	if (!condition)
+	{
+		std::cerr << "FAILED: " << what << '\n';
+		++failures;
+	}
+}
+
+
+// Compares the last frame's commands with what the queue submitted.
+auto CheckFrame(const MC_OpenGL::RecordingDevice& recorder, const MC_OpenGL::RenderQueue& queue) -> int
+{
+	int failures = 0;
+	const std::vector<MC_OpenGL::DeviceCommand>& commands = recorder.Commands();
+	const std::vector<double>& values = recorder.Values();
+	const MC_OpenGL::RecordingStats& stats = recorder.Stats();
+	const MC_OpenGL::RenderQueueStats& queueStats = queue.Stats();
+
+	auto Count = [&](MC_OpenGL::DeviceOp op)
+	{
+		return std::count_if(commands.begin(), commands.end(), [op](const MC_OpenGL::DeviceCommand& command) { return command.op == op; });
+	};
+
+	// Each pass may start with a bind the previous one did not need.
+	const std::size_t passes = 2;
+	Check(stats.draws == queue.Size(), "one draw per queued drawable", failures);
+	Check(stats.uniformSets == 2 * stats.draws, "model and color set once per draw", failures);
+	Check(static_cast<std::size_t>(Count(MC_OpenGL::DeviceOp::UseProgram)) <= queueStats.programChanges + passes, "no more program binds than the sorted queue needs", failures);
+	Check(static_cast<std::size_t>(Count(MC_OpenGL::DeviceOp::BindVertexArray)) <= queueStats.vaoChanges + passes, "no more vertex array binds than the sorted queue needs", failures);
+
+	auto clear = std::find_if(commands.begin(), commands.end(), [](const MC_OpenGL::DeviceCommand& command) { return command.op == MC_OpenGL::DeviceOp::ClearColor; });
+	Check(clear != commands.end() && glm::vec4(values[clear->args[0]], values[clear->args[0] + 1], values[clear->args[0] + 2], values[clear->args[0] + 3]) == clearColor, "clear color recorded", failures);
+
+	// The queue's items are in submission order, and each draw sets its model matrix and then its color.
+	std::size_t item = 0;
+	for (const MC_OpenGL::DeviceCommand& command : commands)
+	{
+		if (command.op != MC_OpenGL::DeviceOp::SetUniform || item >= queue.Items().size())
+			continue;
+
+		const MC_OpenGL::RenderItem& expected = queue.Items()[item];
+		const double* recorded = values.data() + command.args[2];
+		if (command.args[1] == 16)
+		{
+			const float* model = glm::value_ptr(expected.drawable->ModelMatrix());
+			Check(std::equal(model, model + 16, recorded), "model matrix of draw " + std::to_string(item), failures);
+		}
+		else
+		{
+			Check(command.args[1] == 3 && glm::vec3(recorded[0], recorded[1], recorded[2]) == expected.color, "color of draw " + std::to_string(item), failures);
+			++item;
+		}
+	}
+	return failures;
+}
+
+
+}
+
+
+int main(int argc, char* argv[])
+{
+	const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+
+	MC_OpenGL::RecordingDevice recorder;
+	MC_OpenGL::SetDevice(&recorder);
+
+	const std::filesystem::path stl = std::filesystem::temp_directory_path() / "RenderBench.stl";
+	if (!WriteBoxStl(stl, glm::vec3(-0.4f), glm::vec3(0.4f)))
+	{
+		std::cerr << "Error: cannot write " << stl.string() << '\n';
+		return 1;
+	}
+
+	// Two programs interleaved, so an unsorted frame would switch between them on every draw.
+	const MC_OpenGL::Shader shaders[2] = { BenchShader(1), BenchShader(2) };
+	MC_OpenGL::GeometryRegistry geometry;
+	std::vector<std::unique_ptr<MC_OpenGL::Cube>> cubes;
+	std::vector<std::unique_ptr<MC_OpenGL::Triangles>> meshes;
+	std::vector<MC_OpenGL::Drawable*> drawables;
+	for (int i = 0; i < gridSize * gridSize; ++i)
+	{
+		const glm::vec3 position(static_cast<float>(i % gridSize) * 2.f, static_cast<float>(i / gridSize) * 2.f, -static_cast<float>(i % 7));
+		cubes.push_back(std::make_unique<MC_OpenGL::Cube>(shaders[i % 2], glm::translate(glm::mat4(1.f), position)));
+		cubes.back()->SetColor(glm::vec3(static_cast<float>(i % gridSize) / gridSize, static_cast<float>(i / gridSize) / gridSize, 0.5f));
+		cubes.back()->SetSelected(i % 97 == 0);
+		drawables.push_back(cubes.back().get());
+	}
+	for (int i = 0; i < meshCopies; ++i)
+	{
+		meshes.push_back(std::make_unique<MC_OpenGL::Triangles>(shaders[i % 2], geometry, stl.string()));
+		meshes.back()->SetModel(glm::translate(glm::mat4(1.f), glm::vec3(-2.f, 2.f * i, 0.f)));
+		drawables.push_back(meshes.back().get());
+	}
+
+	int failures = 0;
+	Check(geometry.Stats().uploads == 1, "the STL copies share one mesh", failures);
+
+	MC_OpenGL::FrameUniformBuffer frameUniforms;
+	frameUniforms.Initialize();
+	MC_OpenGL::FrameData frameData;
+	frameData.view = glm::lookAt(glm::vec3(gridSize, gridSize, 50.f), glm::vec3(gridSize, gridSize, 0.f), glm::vec3(0.f, 1.f, 0.f));
+
+	MC_OpenGL::RenderQueue queue;
+	std::chrono::steady_clock::duration elapsed{};
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		recorder.Reset();
+		const auto start = std::chrono::steady_clock::now();
+		RenderFrame(drawables, frameUniforms, frameData, queue);
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		// The first frame sets every binding; later ones find some already set.
+		if (frame == 0 || frame + 1 == frames)
+			failures += CheckFrame(recorder, queue);
+	}
+
+	recorder.Report(std::cout);
+	MC_OpenGL::GLState().Report(std::cout);
+	std::cout << drawables.size() << " drawables, " << frames << " frames, "
+		<< std::chrono::duration<double, std::micro>(elapsed).count() / frames << " us per frame\n";
+
+	// The meshes' buffers are deleted on the recorder too.
+	drawables.clear();
+	meshes.clear();
+	cubes.clear();
+	frameUniforms.Release();
+	MC_OpenGL::SetDevice(nullptr);
+	std::filesystem::remove(stl);
+
+	std::cout << (failures == 0 ? "All checks passed\n" : "Checks FAILED\n");
+	return failures == 0 ? 0 : 1;
+}
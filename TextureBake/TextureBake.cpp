@@ -0,0 +1,69 @@
+// Pre-bakes the mip chains of every image in a directory into the texture cache, so that the first launch
+// of MC_OpenGL does not have to decode them either.
+//
+// Usage: TextureBake <texture directory> [cache directory]
+// The cache directory defaults to <texture directory>\cache, which is where TextureManager looks.
+
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "../MC_OpenGL/TextureCache.h"
+
+
+namespace {
+
+
+auto IsImage(const std::filesystem::path& path) -> bool
+{
+	std::string extension = path.extension().string();
+	for (char& c : extension)
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+	return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp" || extension == ".tga";
+}
+
+
+}
+
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: TextureBake <texture directory> [cache directory]\n";
+		return 1;
+	}
+
+	const std::filesystem::path sourceDirectory = argv[1];
+	const std::filesystem::path cacheDirectory = argc == 3 ? std::filesystem::path(argv[2]) : sourceDirectory / "cache";
+
+	std::error_code error;
+	std::filesystem::directory_iterator entries(sourceDirectory, error);
+	if (error)
+	{
+		std::cerr << "Error: cannot read " << sourceDirectory.string() << ": " << error.message() << '\n';
+		return 1;
+	}
+
+	int failures = 0;
+	for (const std::filesystem::directory_entry& entry : entries)
+	{
+		if (!entry.is_regular_file() || !IsImage(entry.path()))
+			continue;
+
+		MC_OpenGL::MipChain chain;
+		if (MC_OpenGL::LoadCachedTexture(entry.path().string(), cacheDirectory, chain) != MC_OpenGL::ErrorCode::NONE)
+		{
+			std::cerr << "Error: failed to bake " << entry.path().string() << '\n';
+			++failures;
+			continue;
+		}
+
+		std::cout << entry.path().filename().string() << ": " << chain.levels.front().width << 'x' << chain.levels.front().height
+			<< ", " << chain.levels.size() << " levels, " << (chain.mapping ? "up to date" : "baked") << '\n';
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// Checks MC_OpenGL's vertex weld on the triangle soup of a jittered, tessellated cube, the way STL files
+// store meshes, and on the same soup with NaN, infinite and huge coordinates added, as malformed files
+// contain them.
+//
+// Usage: WeldTest [seed]
+// Prints a line per case and returns 0 when every check passes.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../MC_OpenGL/MeshWeld.h"
+
+
+namespace {
+
+
+// The layout of the vertex buffers StlReader produces: position (3), texture coords (2), normal (3).
+constexpr std::size_t	floatsPerVertex	= 8;
+constexpr std::size_t	normalOffset	= 5;
+
+constexpr int			gridSize		= 40;		// Quads along each edge of a cube face.
+constexpr float			tolerance		= 1e-3f;
+constexpr float			jitter			= 2e-4f;	// Per axis, so all copies of a grid point are within tolerance.
+
+
+auto AddVertex(std::vector<float>& soup, float x, float y, float z, const float (&n)[3]) -> void
+{
+	soup.insert(soup.end(), { x, y, z, 0.f, 0.f, n[0], n[1], n[2] });
+}
+
+
+// Two triangles per quad and gridSize^2 quads per face of the unit cube, every corner jittered on its own.
+auto CubeSoup(std::mt19937& random) -> std::vector<float>
+{
+	std::uniform_real_distribution<float> offset(-jitter, jitter);
+	std::vector<float> soup;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (int side = 0; side < 2; ++side)
+		{
+			float n[3] = { 0.f, 0.f, 0.f };
+			n[axis] = side == 0 ? -1.f : 1.f;
+
+			for (int u = 0; u < gridSize; ++u)
+			{
+				for (int v = 0; v < gridSize; ++v)
+				{
+					auto Corner = [&](int du, int dv)
+					{
+						float p[3];
+						p[axis] = static_cast<float>(side);
+						p[(axis + 1) % 3] = static_cast<float>(u + du) / gridSize;
+						p[(axis + 2) % 3] = static_cast<float>(v + dv) / gridSize;
+						AddVertex(soup, p[0] + offset(random), p[1] + offset(random), p[2] + offset(random), n);
+					};
+					Corner(0, 0);
+					Corner(1, 0);
+					Corner(1, 1);
+					Corner(0, 0);
+					Corner(1, 1);
+					Corner(0, 1);
+				}
+			}
+		}
+	}
+	return soup;
+}
+
+
+auto Check(bool condition, const std::string& what, int& failures) -> void
+{
+	if (!condition)
+	{
+		std::cerr << "FAILED: " << what << '\n';
+		++failures;
+	}
+}
+
+
+// Weld soup and check that every triangle is kept, every index is in range, every finite vertex stays within
+// tolerance of where it was and every other one is passed through unchanged.
+auto CheckWeld(const std::string& name, const std::vector<float>& soup, float creaseAngleDegrees, std::size_t expectedVertices) -> int
+{
+	int failures = 0;
+	MC_OpenGL::WeldedMesh welded;
+	MC_OpenGL::WeldVertices(soup, floatsPerVertex, normalOffset, tolerance, creaseAngleDegrees, welded);
+
+	const std::size_t numVertices = soup.size() / floatsPerVertex;
+	const std::size_t numWelded = welded.vertices.size() / floatsPerVertex;
+	Check(welded.indices.size() == numVertices, name + ": one index per input vertex", failures);
+	Check(numWelded == expectedVertices, name + ": " + std::to_string(expectedVertices) + " unique vertices, got " + std::to_string(numWelded), failures);
+
+	std::size_t outOfRange = 0;
+	std::size_t moved = 0;
+	for (std::size_t i = 0; i < welded.indices.size() && i < numVertices; ++i)
+	{
+		if (welded.indices[i] >= numWelded)
+		{
+			++outOfRange;
+			continue;
+		}
+
+		const float* p = soup.data() + i * floatsPerVertex;
+		const float* q = welded.vertices.data() + welded.indices[i] * floatsPerVertex;
+		if (std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]))
+		{
+			const double d[3] = { double(p[0]) - q[0], double(p[1]) - q[1], double(p[2]) - q[2] };
+			moved += std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) > tolerance ? 1 : 0;
+		}
+		else
+		{
+			for (int axis = 0; axis < 3; ++axis)
+				moved += (p[axis] == q[axis] || (std::isnan(p[axis]) && std::isnan(q[axis]))) ? 0 : 1;
+		}
+	}
+	Check(outOfRange == 0, name + ": " + std::to_string(outOfRange) + " indices out of range", failures);
+	Check(moved == 0, name + ": " + std::to_string(moved) + " vertices moved further than the tolerance", failures);
+
+	std::cout << name << ": " << numVertices << " vertices, " << numVertices / 3 << " triangles, " << numWelded << " after welding"
+		<< (failures == 0 ? "" : ", FAILED") << '\n';
+	return failures;
+}
+
+
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::mt19937 random(argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1u);
+	const std::vector<float> cube = CubeSoup(random);
+
+	// Each face keeps its own copy of the grid points on the cube's edges, whose normals are 90 degrees apart.
+	const std::size_t faceGridPoints = std::size_t(gridSize + 1) * (gridSize + 1);
+	const std::size_t surfaceGridPoints = 6 * std::size_t(gridSize) * gridSize + 2;
+	int failures = 0;
+	failures += CheckWeld("creased", cube, 30.f, 6 * faceGridPoints);
+	failures += CheckWeld("smooth", cube, 180.f, surfaceGridPoints);
+
+	// Non-finite vertices are never merged, not even with an identical copy. Huge finite ones still are.
+	const float up[3] = { 0.f, 0.f, 1.f };
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float infinity = std::numeric_limits<float>::infinity();
+	const float huge = std::numeric_limits<float>::max();
+	std::vector<float> malformed = cube;
+	for (int copy = 0; copy < 2; ++copy)
+	{
+		AddVertex(malformed, nan, 0.f, 0.f, up);
+		AddVertex(malformed, 1.f, nan, 0.f, up);
+		AddVertex(malformed, 0.f, 1.f, nan, up);
+
+		AddVertex(malformed, infinity, 0.f, 0.f, up);
+		AddVertex(malformed, 0.f, -infinity, 0.f, up);
+		AddVertex(malformed, 0.f, 0.f, infinity, up);
+
+		AddVertex(malformed, huge, 0.f, 0.f, up);
+		AddVertex(malformed, 0.f, -huge, 0.f, up);
+		AddVertex(malformed, 1e30f, 1e30f, -1e30f, up);
+	}
+	failures += CheckWeld("malformed", malformed, 30.f, 6 * faceGridPoints + 2 * 6 + 3);
+
+	std::cout << (failures == 0 ? "All checks passed\n" : "Checks FAILED\n");
+	return failures == 0 ? 0 : 1;
+}
@@ -6,9 +6,14 @@ in vec3 FragPos;
 out vec4 FragColor;
   
 uniform vec3 objectColor;
-uniform vec3 lightColor;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
+
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 viewPos;
+	vec3 lightColor;
+};
 
 void main()
 {
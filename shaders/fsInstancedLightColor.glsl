@@ -0,0 +1,35 @@
+#version 330 core
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec3 ObjectColor;
+
+out vec4 FragColor;
+  
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 viewPos;
+	vec3 lightColor;
+};
+
+void main()
+{
+	float ambientStrength = 0.4;
+	vec3 ambient = ambientStrength * lightColor;
+	
+	vec3 norm = normalize(Normal);
+	vec3 lightDir = normalize(vec3(viewPos[0], viewPos[1], viewPos[2] + 1.0) - FragPos);
+	float diff = max(dot(norm, lightDir), 0.0);
+	vec3 diffuse = diff*lightColor;
+	
+	float specularStrength = 0.5;
+	vec3 viewDir = normalize(vec3(viewPos[0], viewPos[1], viewPos[2] + 1.0) - FragPos);
+	vec3 reflectDir = reflect(-lightDir, norm);  
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), 2);
+	vec3 specular = specularStrength * spec * lightColor;  
+	
+	vec3 result = (ambient + diffuse + specular) * ObjectColor;
+    FragColor = vec4(result, 1.0);
+}
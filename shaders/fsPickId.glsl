@@ -0,0 +1,10 @@
+#version 330 core
+out uvec2 PickId;
+
+// 0 is reserved for the background.
+uniform uint objectId;
+
+void main()
+{
+	PickId = uvec2(objectId, uint(gl_PrimitiveID));
+}
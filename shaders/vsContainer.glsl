@@ -8,8 +8,14 @@ out vec3 vsOutCol;
 out vec2 vsOutTex;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 viewPos;
+	vec3 lightColor;
+};
 
 void main ()
 {
@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 texCoord;
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in vec3 instanceColor;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 ObjectColor;
+
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 viewPos;
+	vec3 lightColor;
+};
+
+void main()
+{
+	FragPos = vec3(view*instanceModel*vec4(aPos, 1.0));
+	Normal = mat3(transpose(inverse(view*instanceModel))) * aNormal;
+	ObjectColor = instanceColor;
+	
+    gl_Position = projection * view * instanceModel * vec4(aPos, 1.0f);
+}